@@ -25,6 +25,7 @@
 void __early_init(void) {
 
   fe310_clock_init();
+  fe310PconInit();
 }
 
 /**
@@ -734,6 +734,7 @@
  */
 #define CH_CFG_SYSTEM_HALT_HOOK(reason) {                                   \
   /* System halt code here.*/                                               \
+  fe310PconHalt(reason);                                                    \
 }
 
 /**
@@ -751,6 +752,16 @@
 /* Port-specific settings (override port settings defaulted in chcore.h).    */
 /*===========================================================================*/
 
+#if !defined(_FROM_ASM_)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void fe310PconHalt(const char *reason);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
 #endif  /* CHCONF_H */
 
 /** @} */
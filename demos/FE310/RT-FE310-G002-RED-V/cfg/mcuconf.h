@@ -40,4 +40,8 @@
 #define FE310_SERIAL_USE_UART0 TRUE
 #define FE310_SERIAL_USE_UART1 TRUE
 
+#define FE310_USE_PCON TRUE
+
+#define FE310_USE_XIP TRUE
+
 #endif /* MCUCONF_H */
@@ -0,0 +1,223 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+#include "chprintf.h"
+
+/*
+ * Bytes sent by each throughput run, a multiple of BENCH_CHUNK.
+ */
+#define BENCH_BYTES             16384U
+#define BENCH_CHUNK             64U
+
+/*
+ * Single byte round trips measured by each latency run.
+ */
+#define BENCH_ROUNDS            64U
+
+/*
+ * Silence ending a run.
+ */
+#define BENCH_TIMEOUT           TIME_MS2I(200)
+
+/*
+ * RX idle timeout used with watermarks above one.
+ */
+#define BENCH_RXIDLE            TIME_MS2I(1)
+
+static const uint32_t bench_speeds[] = {115200, 921600, 2000000};
+
+static const struct {
+  uint8_t                   rxwm;
+  uint8_t                   txwm;
+} bench_watermarks[] = {{1, 1}, {4, 4}, {8, 7}};
+
+#define ARRAY_LEN(a)            (sizeof (a) / sizeof ((a)[0]))
+
+static BaseSequentialStream *const out = (BaseSequentialStream *)&SD0;
+
+/*
+ * Receiver side of a throughput run, SD1 is looped back on itself.
+ */
+static struct {
+  uint32_t                  received;
+  uint32_t                  errors;
+  systime_t                 end;
+} rx;
+
+static THD_WORKING_AREA(waReceiver, 512);
+static THD_FUNCTION(Receiver, arg) {
+  uint8_t buf[BENCH_CHUNK];
+  size_t i, n;
+
+  (void)arg;
+
+  chRegSetThreadName("receiver");
+  rx.received = 0;
+  rx.errors = 0;
+  while (rx.received < BENCH_BYTES) {
+    n = chnReadTimeout(&SD1, buf, sizeof buf, BENCH_TIMEOUT);
+    if (n == 0)
+      break;
+    for (i = 0; i < n; i++) {
+      if (buf[i] != (uint8_t)(rx.received + i))
+        rx.errors++;
+    }
+    rx.received += n;
+    rx.end = chVTGetSystemTimeX();
+  }
+}
+
+/*
+ * Bytes per second over a system time interval.
+ */
+static uint32_t rate(uint32_t bytes, systime_t start, systime_t end) {
+  sysinterval_t ticks = chTimeDiffX(start, end);
+
+  if (ticks == (sysinterval_t)0)
+    return 0;
+  return (uint32_t)(((uint64_t)bytes * CH_CFG_ST_FREQUENCY) / ticks);
+}
+
+/*
+ * Runs the throughput and latency measurements for one configuration and
+ * prints a JSON line.
+ */
+static void bench_run(uint32_t speed, uint8_t rxwm, uint8_t txwm) {
+  SerialConfig cfg = {
+    speed,
+    rxwm,
+    rxwm > 1U ? BENCH_RXIDLE : (sysinterval_t)0,
+    txwm,
+    1
+  };
+  fe310_serial_stats_t st;
+  uint8_t buf[BENCH_CHUNK];
+  thread_t *tp;
+  systime_t start, txend;
+  rtcnt_t t0, dt, lat_min, lat_max, lat_sum;
+  uint32_t i, lat_lost;
+  uint64_t moved;
+
+  sdStop(&SD1);
+  sdStart(&SD1, &cfg);
+  while (chnGetTimeout(&SD1, TIME_MS2I(20)) >= MSG_OK) {
+  }
+  fe310SerialResetStatistics(&SD1);
+
+  /* Sustained throughput, the receiver runs at a higher priority so the
+     input queue is emptied as soon as data is inserted.*/
+  tp = chThdCreateStatic(waReceiver, sizeof(waReceiver), NORMALPRIO + 1,
+                         Receiver, NULL);
+  start = chVTGetSystemTimeX();
+  for (i = 0; i < BENCH_BYTES; i += BENCH_CHUNK) {
+    uint32_t j;
+    for (j = 0; j < BENCH_CHUNK; j++)
+      buf[j] = (uint8_t)(i + j);
+    chnWrite(&SD1, buf, BENCH_CHUNK);
+  }
+  txend = chVTGetSystemTimeX();
+  chThdWait(tp);
+  fe310SerialGetStatistics(&SD1, &st);
+
+  /* Round trip of single bytes, with watermarks above one this includes
+     the RX idle timeout.*/
+  lat_min = (rtcnt_t)-1;
+  lat_max = 0;
+  lat_sum = 0;
+  lat_lost = 0;
+  for (i = 0; i < BENCH_ROUNDS; i++) {
+    t0 = chSysGetRealtimeCounterX();
+    sdPut(&SD1, (uint8_t)i);
+    if (chnGetTimeout(&SD1, BENCH_TIMEOUT) != (msg_t)(uint8_t)i) {
+      lat_lost++;
+      continue;
+    }
+    dt = chSysGetRealtimeCounterX() - t0;
+    lat_sum += dt;
+    if (dt < lat_min)
+      lat_min = dt;
+    if (dt > lat_max)
+      lat_max = dt;
+  }
+  if (lat_lost == BENCH_ROUNDS)
+    lat_min = 0;
+
+  moved = (uint64_t)st.rxbytes + st.txbytes;
+  chprintf(out,
+           "{\"speed\":%u,\"baud\":%u,\"rxwm\":%u,\"txwm\":%u,"
+           "\"tx_bps\":%u,\"rx_bps\":%u,\"rx_bytes\":%u,\"rx_errors\":%u,"
+           "\"isrs\":%u,\"isr_cycles_per_byte\":%u,"
+           "\"queue_full\":%u,\"lost\":%u,"
+           "\"lat_cycles_min\":%u,\"lat_cycles_avg\":%u,"
+           "\"lat_cycles_max\":%u,\"lat_lost\":%u}\r\n",
+           speed, SD1.baud, rxwm, txwm,
+           rate(BENCH_BYTES, start, txend),
+           rate(rx.received, start, rx.end),
+           rx.received, rx.errors,
+           st.isrs, moved > 0U ? (uint32_t)(st.cycles / moved) : 0U,
+           st.overflows, st.lost,
+           (uint32_t)lat_min,
+           lat_lost < BENCH_ROUNDS ?
+             (uint32_t)(lat_sum / (BENCH_ROUNDS - lat_lost)) : 0U,
+           (uint32_t)lat_max, lat_lost);
+}
+
+/*
+ * Application entry point.
+ */
+int main(void) {
+  size_t i, j;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * Serial driver 0 is the results console, GPIO 16(RX) and 17(TX).
+   * Serial driver 1 is under test, GPIO 23(RX) and 18(TX) must be wired
+   * together on the board.
+   */
+  sdStart(&SD0, NULL);
+  palSetPadMode(GPIO0, 16, PAL_MODE_ALTERNATE(0));
+  palSetPadMode(GPIO0, 17, PAL_MODE_ALTERNATE(0));
+  palSetPadMode(GPIO0, 18, PAL_MODE_ALTERNATE(0));
+  palSetPadMode(GPIO0, 23, PAL_MODE_ALTERNATE(0));
+
+  chprintf(out, "{\"bench\":\"serial\",\"coreclk\":%u,\"st_frequency\":%u,"
+                "\"bytes\":%u,\"rounds\":%u}\r\n",
+           FE310_CORECLK, CH_CFG_ST_FREQUENCY, BENCH_BYTES, BENCH_ROUNDS);
+
+  for (i = 0; i < ARRAY_LEN(bench_speeds); i++) {
+    for (j = 0; j < ARRAY_LEN(bench_watermarks); j++) {
+      bench_run(bench_speeds[i], bench_watermarks[j].rxwm,
+                bench_watermarks[j].txwm);
+    }
+  }
+
+  chprintf(out, "{\"done\":true}\r\n");
+
+  while (true) {
+    chThdSleepMilliseconds(500);
+  }
+}
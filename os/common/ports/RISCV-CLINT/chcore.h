@@ -89,12 +89,6 @@
 #error "unsupported compiler"
 #endif
 
-/**
- * @brief   Port-specific information string.
- */
-#define PORT_INFO                       "no info"
-/** @} */
-
 /* Inclusion of the RISC-V implementation specific parameters.*/
 #include "riscvparams.h"
 
@@ -138,10 +132,67 @@
 #define PORT_RISCV_ENABLE_WFI_IDLE      FALSE
 #endif
 
+/**
+ * @brief   Simplified priority handling flag.
+ * @details Activating this option makes the kernel lock work by clearing
+ *          @p mstatus.MIE, all the interrupt sources are masked by critical
+ *          zones.<br>
+ *          When this option is disabled the kernel lock raises the PLIC
+ *          priority threshold to @p PORT_RISCV_MAX_KERNEL_PRIORITY and
+ *          masks the machine timer interrupt, PLIC sources with a priority
+ *          above that level are never masked by the kernel and can also
+ *          preempt kernel-level ISRs.
+ * @note    Sources above the kernel priority level are "fast" interrupts,
+ *          they must be declared using @p PORT_FAST_IRQ_HANDLER() and are
+ *          not allowed to invoke any OS API.
+ */
+#if !defined(PORT_RISCV_SIMPLIFIED_PRIORITY) || defined(__DOXYGEN__)
+#define PORT_RISCV_SIMPLIFIED_PRIORITY  TRUE
+#endif
+
+/**
+ * @brief   Highest PLIC priority level of kernel-aware interrupt sources.
+ * @details This is the PLIC threshold applied by the kernel lock when
+ *          @p PORT_RISCV_SIMPLIFIED_PRIORITY is disabled.
+ */
+#if !defined(PORT_RISCV_MAX_KERNEL_PRIORITY) || defined(__DOXYGEN__)
+#define PORT_RISCV_MAX_KERNEL_PRIORITY  5
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY || defined(__DOXYGEN__)
+#if !defined(RISCV_PLIC_BASE) || !defined(RISCV_PLIC_MAX_PRIO)
+#error "threshold based kernel lock requires RISCV_PLIC_BASE and RISCV_PLIC_MAX_PRIO"
+#endif
+
+#if (PORT_RISCV_MAX_KERNEL_PRIORITY < 1) ||                                 \
+    (PORT_RISCV_MAX_KERNEL_PRIORITY >= RISCV_PLIC_MAX_PRIO)
+#error "invalid PORT_RISCV_MAX_KERNEL_PRIORITY value specified"
+#endif
+
+/**
+ * @brief   Address of the PLIC threshold register of hart 0 M-mode context.
+ */
+#define PORT_RISCV_PLIC_THRESHOLD_ADDR  (RISCV_PLIC_BASE + 0x200000)
+
+/**
+ * @brief   Machine timer interrupt enable bit in @p mie.
+ */
+#define PORT_RISCV_MIE_MTIE             0x80
+#endif /* !PORT_RISCV_SIMPLIFIED_PRIORITY */
+
+/**
+ * @brief   Port-specific information string.
+ */
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY || defined(__DOXYGEN__)
+#define PORT_INFO                       "Advanced kernel mode"
+#else
+#define PORT_INFO                       "Compact kernel mode"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -218,6 +269,19 @@ struct port_context {
   struct port_intctx *sp;
 };
 
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY || defined(__DOXYGEN__)
+/**
+ * @brief   Trap state preserved while an ISR can be preempted.
+ * @details A nested trap overwrites @p mepc and changes the kernel lock
+ *          state, this structure holds what has to be restored before
+ *          returning from the outer trap.
+ */
+struct port_nestctx {
+  uint32_t mepc;
+  uint32_t mie;
+};
+#endif
+
 #endif /* !defined(_FROM_ASM_) */
 
 /*===========================================================================*/
@@ -257,15 +321,22 @@ struct port_context {
 #define PORT_WORKING_AREA(s, n)                                             \
   stkalign_t s[THD_WORKING_AREA_SIZE(n) / sizeof (stkalign_t)]
 
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY || defined(__DOXYGEN__)
 /**
  * @brief   Priority level verification macro.
  */
-#define PORT_IRQ_IS_VALID_PRIORITY(n) true
+#define PORT_IRQ_IS_VALID_PRIORITY(n)                                       \
+  (((n) >= 1U) && ((n) <= RISCV_PLIC_MAX_PRIO))
 
 /**
  * @brief   Priority level verification macro.
  */
+#define PORT_IRQ_IS_VALID_KERNEL_PRIORITY(n)                                \
+  (((n) >= 1U) && ((n) <= PORT_RISCV_MAX_KERNEL_PRIORITY))
+#else
+#define PORT_IRQ_IS_VALID_PRIORITY(n) true
 #define PORT_IRQ_IS_VALID_KERNEL_PRIORITY(n) true
+#endif
 
 /**
  * @brief   IRQ prologue code.
@@ -297,14 +368,17 @@ struct port_context {
 
 /**
  * @brief   Fast IRQ handler function declaration.
+ * @details Fast handlers are dispatched by the PLIC code like any other
+ *          handler so they share the same signature, the returned value
+ *          is ignored and should be @p false.
  * @note    @p id can be a function name or a vector number depending on the
  *          port implementation.
  */
-// #ifdef __cplusplus
-// #define PORT_FAST_IRQ_HANDLER(id) extern "C" __attribute__((interrupt)) void id(void)
-// #else
-// #define PORT_FAST_IRQ_HANDLER(id) __attribute__((interrupt)) void id(void)
-// #endif
+#ifdef __cplusplus
+#define PORT_FAST_IRQ_HANDLER(id) extern "C" bool id(void)
+#else
+#define PORT_FAST_IRQ_HANDLER(id) bool id(void)
+#endif
 
 /**
  * @brief   Performs a context switch between two threads.
@@ -336,6 +410,16 @@ struct port_context {
 #define RISCV_CSR_SET(csr, var) asm volatile("csrs " #csr ", %0" : : "r"(var))
 #define RISCV_CSR_SET_I(csr, val) asm volatile("csrsi " #csr ", " #val)
 
+#define RISCV_CSR_READ_CLEAR_I(var, csr, val) asm volatile("csrrci %0, " #csr ", " #val : "=r"(var))
+
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY || defined(__DOXYGEN__)
+/**
+ * @brief   PLIC threshold register used by the kernel lock.
+ */
+#define PORT_RISCV_PLIC_THRESHOLD                                           \
+  (*(volatile uint32_t *)PORT_RISCV_PLIC_THRESHOLD_ADDR)
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -371,7 +455,14 @@ extern "C" {
  */
 static inline void port_init(void) {
 
+#if PORT_RISCV_SIMPLIFIED_PRIORITY
   uint32_t meie = 0x800;
+#else
+  /* The timer interrupt enable is part of the kernel lock state, the
+     ST driver gates the alarm using the comparator instead.*/
+  uint32_t meie = 0x800 | PORT_RISCV_MIE_MTIE;
+  PORT_RISCV_PLIC_THRESHOLD = 0;
+#endif
   RISCV_CSR_SET (mie, meie);
 }
 
@@ -384,6 +475,10 @@ static inline syssts_t port_get_irq_status(void) {
 
   syssts_t status;
   RISCV_CSR_READ (status, mstatus);
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+  /* MIE bit plus the current threshold in the upper bits.*/
+  status = (status & 0x8) | (PORT_RISCV_PLIC_THRESHOLD << 4);
+#endif
   return status;
 }
 
@@ -398,8 +493,13 @@ static inline syssts_t port_get_irq_status(void) {
  */
 static inline bool port_irq_enabled(syssts_t sts) {
 
+#if PORT_RISCV_SIMPLIFIED_PRIORITY
   // Check if MIE is set.
   return sts & 0x8;
+#else
+  // MIE set and no threshold applied.
+  return sts == 0x8;
+#endif
 }
 
 /**
@@ -421,7 +521,18 @@ static inline bool port_is_isr_context(void) {
  */
 static inline void port_lock(void) {
 
+#if PORT_RISCV_SIMPLIFIED_PRIORITY
   RISCV_CSR_CLEAR_I (mstatus, 0x8);
+#else
+  /* The threshold and MTIE updates must not be split by a trap, MIE is
+     dropped for the two instructions and then restored.*/
+  uint32_t sts;
+  uint32_t mtie = PORT_RISCV_MIE_MTIE;
+  RISCV_CSR_READ_CLEAR_I (sts, mstatus, 0x8);
+  PORT_RISCV_PLIC_THRESHOLD = PORT_RISCV_MAX_KERNEL_PRIORITY;
+  RISCV_CSR_CLEAR (mie, mtie);
+  RISCV_CSR_SET (mstatus, sts & 0x8);
+#endif
 }
 
 /**
@@ -431,6 +542,12 @@ static inline void port_lock(void) {
  */
 static inline void port_unlock(void) {
 
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+  uint32_t mtie = PORT_RISCV_MIE_MTIE;
+  PORT_RISCV_PLIC_THRESHOLD = 0;
+  RISCV_CSR_SET (mie, mtie);
+#endif
+  /* MIE can be clear after a switch from the post-ISR path.*/
   RISCV_CSR_SET_I (mstatus, 0x8);
 }
 
@@ -469,8 +586,15 @@ static inline void port_disable(void) {
  */
 static inline void port_suspend(void) {
 
-  // TODO: Prioritized mask?
+#if PORT_RISCV_SIMPLIFIED_PRIORITY
   RISCV_CSR_CLEAR_I (mstatus, 0x8);
+#else
+  uint32_t mtie = PORT_RISCV_MIE_MTIE;
+  RISCV_CSR_CLEAR_I (mstatus, 0x8);
+  PORT_RISCV_PLIC_THRESHOLD = PORT_RISCV_MAX_KERNEL_PRIORITY;
+  RISCV_CSR_CLEAR (mie, mtie);
+  RISCV_CSR_SET_I (mstatus, 0x8);
+#endif
 }
 
 /**
@@ -478,9 +602,59 @@ static inline void port_suspend(void) {
  */
 static inline void port_enable(void) {
 
+  port_unlock();
+}
+
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY || defined(__DOXYGEN__)
+/**
+ * @brief   Lets fast interrupt sources preempt the current ISR.
+ * @details The kernel lock is applied and MIE is set again, only sources
+ *          above @p PORT_RISCV_MAX_KERNEL_PRIORITY can be taken until
+ *          @p port_isr_nest_end() is invoked.
+ * @note    Must be called with MIE clear, from trap context.
+ *
+ * @param[out] ncp      trap state to be restored later
+ */
+static inline void port_isr_nest_begin(struct port_nestctx *ncp) {
+  uint32_t mtie = PORT_RISCV_MIE_MTIE;
+
+  RISCV_CSR_READ (ncp->mepc, mepc);
+  RISCV_CSR_READ (ncp->mie, mie);
+  PORT_RISCV_PLIC_THRESHOLD = PORT_RISCV_MAX_KERNEL_PRIORITY;
+  RISCV_CSR_CLEAR (mie, mtie);
   RISCV_CSR_SET_I (mstatus, 0x8);
 }
 
+/**
+ * @brief   Closes a window opened by @p port_isr_nest_begin().
+ * @details MIE is cleared and the trap state is restored as it was on ISR
+ *          entry, the threshold is zero there because kernel-level traps
+ *          are only taken outside the kernel lock.
+ *
+ * @param[in] ncp       trap state saved by @p port_isr_nest_begin()
+ */
+static inline void port_isr_nest_end(const struct port_nestctx *ncp) {
+  uint32_t mtie = ncp->mie & PORT_RISCV_MIE_MTIE;
+
+  RISCV_CSR_CLEAR_I (mstatus, 0x8);
+  RISCV_CSR_WRITE (mepc, ncp->mepc);
+  PORT_RISCV_PLIC_THRESHOLD = 0;
+  RISCV_CSR_SET (mie, mtie);
+}
+
+/**
+ * @brief   Checks if a trap has been taken inside the kernel lock.
+ * @details In this case only fast sources can be pending and no OS API can
+ *          be invoked by the trap handler.
+ *
+ * @return              The kernel lock state.
+ */
+static inline bool port_is_kernel_locked(void) {
+
+  return PORT_RISCV_PLIC_THRESHOLD >= PORT_RISCV_MAX_KERNEL_PRIORITY;
+}
+#endif /* !PORT_RISCV_SIMPLIFIED_PRIORITY */
+
 /**
  * @brief   Enters an architecture-dependent IRQ-waiting mode.
  * @details The function is meant to return when an interrupt becomes pending.
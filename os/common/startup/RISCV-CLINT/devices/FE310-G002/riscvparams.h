@@ -25,7 +25,20 @@
 #ifndef _RISCVPARAMS_H_
 #define _RISCVPARAMS_H_
 
-// Nothing to include for now.
+/**
+ * @name    PLIC parameters required by the port layer
+ * @{
+ */
+/**
+ * @brief   Base address of the PLIC.
+ */
+#define RISCV_PLIC_BASE                     0x0C000000
+
+/**
+ * @brief   Highest priority level implemented by the PLIC.
+ */
+#define RISCV_PLIC_MAX_PRIO                 7
+/** @} */
 
 #endif /* _RISCVPARAMS_H_ */
 
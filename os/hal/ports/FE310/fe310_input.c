@@ -0,0 +1,252 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_input.c
+ * @brief   FE310 debounced inputs and edge counters code.
+ *
+ * @addtogroup FE310_INPUT
+ * @{
+ */
+
+#include "hal.h"
+
+#if (FE310_USE_INPUT == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Started inputs, indexed by pad.
+ */
+static fe310_input_t *inputs[PAL_IOPORTS_WIDTH];
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Samples the level and notifies a change.
+ * @note    Called from a lock zone.
+ *
+ * @param[in] ip        pointer to the input object
+ */
+static void input_sample(fe310_input_t *ip) {
+  uint32_t level = palReadLine(ip->config->line);
+
+  if (level != ip->level) {
+    ip->level = level;
+    ip->changes++;
+    if (ip->config->cb != NULL) {
+      ip->config->cb(ip);
+    }
+    osalThreadDequeueAllI(&ip->queue, (msg_t)level);
+  }
+}
+
+/**
+ * @brief   Debounce window expired.
+ *
+ * @param[in] p         pointer to the input object
+ */
+static void input_settle_cb(void *p) {
+  fe310_input_t *ip = (fe310_input_t *)p;
+
+  osalSysLockFromISR();
+  if (ip->config != NULL) {
+    input_sample(ip);
+  }
+  osalSysUnlockFromISR();
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Pad interrupt code.
+ * @details Called by the PAL pad handlers after clearing the latches.
+ *
+ * @param[in] pad       the pad number
+ * @param[in] edges     number of edges latched, zero to two
+ *
+ * @notapi
+ */
+void _fe310_input_serve(uint32_t pad, uint32_t edges) {
+  fe310_input_t *ip = inputs[pad];
+
+  if (ip == NULL) {
+    return;
+  }
+
+  /* Single writer, the readers see either the old or the new value.*/
+  ip->stamp = RISCV_MTIME;
+  ip->edges += edges;
+
+  osalSysLockFromISR();
+  if (ip->config->debounce == (sysinterval_t)0) {
+    input_sample(ip);
+  }
+  else {
+    /* Each edge restarts the window.*/
+    chVTSetI(&ip->vt, ip->config->debounce, input_settle_cb, ip);
+  }
+  osalSysUnlockFromISR();
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an input object.
+ *
+ * @param[out] ip       pointer to the input object
+ *
+ * @init
+ */
+void fe310InputObjectInit(fe310_input_t *ip) {
+
+  ip->config  = NULL;
+  ip->edges   = 0U;
+  ip->stamp   = 0U;
+  ip->changes = 0U;
+  ip->level   = PAL_LOW;
+  chVTObjectInit(&ip->vt);
+  osalThreadQueueObjectInit(&ip->queue);
+}
+
+/**
+ * @brief   Starts an input.
+ * @details The counters are reset and the level is sampled.
+ * @note    PAL events must not be enabled on the same line.
+ *
+ * @param[in] ip        pointer to the input object
+ * @param[in] config    pointer to the configuration
+ *
+ * @api
+ */
+void fe310InputStart(fe310_input_t *ip, const fe310_input_config_t *config) {
+  ioportid_t port;
+  uint32_t pad, m;
+
+  osalDbgCheck((ip != NULL) && (config != NULL));
+
+  port = PAL_PORT(config->line);
+  pad  = PAL_PAD(config->line);
+  m    = 1U << pad;
+
+  osalDbgCheck((port == GPIO0) && (pad < PAL_IOPORTS_WIDTH));
+
+  osalSysLock();
+  osalDbgAssert((ip->config == NULL) && (inputs[pad] == NULL),
+                "already started");
+  ip->config  = config;
+  ip->edges   = 0U;
+  ip->changes = 0U;
+  ip->stamp   = RISCV_MTIME;
+  ip->level   = palReadLine(config->line);
+  inputs[pad] = ip;
+  osalSysUnlock();
+
+  /* Edges seen before the call are not counted.*/
+  port->RISE_IP = m;
+  port->FALL_IP = m;
+  riscv_atomic_or(&port->RISE_IE, m);
+  riscv_atomic_or(&port->FALL_IE, m);
+  plicEnableInterrupt(FE310_GPIO0_FIRST_NUMBER + pad, FE310_PAL_IRQ_PRIORITY);
+}
+
+/**
+ * @brief   Stops an input.
+ * @details Waiting threads are released with @p MSG_RESET, the counters
+ *          keep their last values.
+ *
+ * @param[in] ip        pointer to the input object
+ *
+ * @api
+ */
+void fe310InputStop(fe310_input_t *ip) {
+  ioportid_t port;
+  uint32_t pad, m;
+
+  osalDbgCheck((ip != NULL) && (ip->config != NULL));
+
+  port = PAL_PORT(ip->config->line);
+  pad  = PAL_PAD(ip->config->line);
+  m    = 1U << pad;
+
+  plicDisableInterrupt(FE310_GPIO0_FIRST_NUMBER + pad);
+  riscv_atomic_and(&port->RISE_IE, ~m);
+  riscv_atomic_and(&port->FALL_IE, ~m);
+  port->RISE_IP = m;
+  port->FALL_IP = m;
+
+  osalSysLock();
+  if (chVTIsArmedI(&ip->vt)) {
+    chVTResetI(&ip->vt);
+  }
+  inputs[pad] = NULL;
+  ip->config  = NULL;
+  osalThreadDequeueAllI(&ip->queue, MSG_RESET);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Waits for a debounced level change.
+ *
+ * @param[in] ip        pointer to the input object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The new level or an error code.
+ * @retval MSG_TIMEOUT  if the level did not change within the timeout.
+ * @retval MSG_RESET    if the input has been stopped.
+ *
+ * @api
+ */
+msg_t fe310InputWaitTimeout(fe310_input_t *ip, sysinterval_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck(ip != NULL);
+
+  osalSysLock();
+  if (ip->config == NULL) {
+    msg = MSG_RESET;
+  }
+  else {
+    msg = osalThreadEnqueueTimeoutS(&ip->queue, timeout);
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+#endif /* FE310_USE_INPUT == TRUE */
+
+/** @} */
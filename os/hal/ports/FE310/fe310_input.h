@@ -0,0 +1,201 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_input.h
+ * @brief   FE310 debounced inputs and edge counters header.
+ * @details Each input owns a GPIO0 pad interrupt on both edges. The edges
+ *          latched in @p RISE_IP and @p FALL_IP are counted and time
+ *          stamped with the CLINT @p mtime from the interrupt, the level
+ *          is then sampled after a debounce window and threads are only
+ *          woken when the debounced level changes.
+ *
+ * @addtogroup FE310_INPUT
+ * @{
+ */
+
+#ifndef FE310_INPUT_H
+#define FE310_INPUT_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Debounced inputs enable switch.
+ */
+#if !defined(FE310_USE_INPUT) || defined(__DOXYGEN__)
+#define FE310_USE_INPUT                     FALSE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (FE310_USE_INPUT == TRUE) &&                                            \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_PAL_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to PAL"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of an input object.
+ */
+typedef struct fe310_input fe310_input_t;
+
+/**
+ * @brief   Debounced level change callback type.
+ */
+typedef void (*fe310_input_cb_t)(fe310_input_t *ip);
+
+/**
+ * @brief   Input configuration.
+ */
+typedef struct {
+  /**
+   * @brief   Input line, a GPIO0 pad already programmed as input.
+   */
+  ioline_t                  line;
+  /**
+   * @brief   Debounce window.
+   * @details The level is sampled once no edge has been seen for this
+   *          interval, zero samples it from the edge interrupt.
+   */
+  sysinterval_t             debounce;
+  /**
+   * @brief   Debounced level change callback, can be @p NULL.
+   * @note    Called from ISR context.
+   */
+  fe310_input_cb_t          cb;
+} fe310_input_config_t;
+
+/**
+ * @brief   Input object.
+ */
+struct fe310_input {
+  /**
+   * @brief   Current configuration, @p NULL when stopped.
+   */
+  const fe310_input_config_t *config;
+  /**
+   * @brief   Edges counted since the start, wraps around.
+   */
+  volatile uint32_t         edges;
+  /**
+   * @brief   CLINT @p mtime low word at the last edge.
+   */
+  volatile uint32_t         stamp;
+  /**
+   * @brief   Debounced level changes since the start, wraps around.
+   */
+  volatile uint32_t         changes;
+  /**
+   * @brief   Debounced level, @p PAL_LOW or @p PAL_HIGH.
+   */
+  volatile uint32_t         level;
+  /**
+   * @brief   Debounce timer.
+   */
+  virtual_timer_t           vt;
+  /**
+   * @brief   Threads waiting for a level change.
+   */
+  threads_queue_t           queue;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of edges.
+ * @details Two latched edges are counted at most per interrupt, pulses
+ *          shorter than the interrupt latency are undercounted.
+ * @note    Lock free, it can be called from any context.
+ *
+ * @param[in] ip        pointer to the input object
+ * @return              The edges count, modulo 2^32.
+ *
+ * @xclass
+ */
+#define fe310InputGetEdgesX(ip) ((ip)->edges)
+
+/**
+ * @brief   Returns the time stamp of the last edge.
+ * @note    Lock free, it can be called from any context.
+ *
+ * @param[in] ip        pointer to the input object
+ * @return              The CLINT @p mtime low word.
+ *
+ * @xclass
+ */
+#define fe310InputGetStampX(ip) ((ip)->stamp)
+
+/**
+ * @brief   Returns the number of debounced level changes.
+ * @note    Lock free, it can be called from any context.
+ *
+ * @param[in] ip        pointer to the input object
+ * @return              The changes count, modulo 2^32.
+ *
+ * @xclass
+ */
+#define fe310InputGetChangesX(ip) ((ip)->changes)
+
+/**
+ * @brief   Returns the debounced level.
+ * @note    Lock free, it can be called from any context.
+ *
+ * @param[in] ip        pointer to the input object
+ * @return              @p PAL_LOW or @p PAL_HIGH.
+ *
+ * @xclass
+ */
+#define fe310InputGetLevelX(ip) ((ip)->level)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (FE310_USE_INPUT == TRUE) || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void fe310InputObjectInit(fe310_input_t *ip);
+  void fe310InputStart(fe310_input_t *ip, const fe310_input_config_t *config);
+  void fe310InputStop(fe310_input_t *ip);
+  msg_t fe310InputWaitTimeout(fe310_input_t *ip, sysinterval_t timeout);
+  void _fe310_input_serve(uint32_t pad, uint32_t edges);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+#endif /* FE310_INPUT_H */
+
+/** @} */
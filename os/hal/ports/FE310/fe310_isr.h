@@ -42,6 +42,22 @@
 
 #define FE310_UART0_NUMBER          3
 #define FE310_UART1_NUMBER          4
+
+/*
+ * SPI units.
+ */
+#define FE310_QSPI0_HANDLER         PlicInterrupt5
+#define FE310_SPI1_HANDLER          PlicInterrupt6
+#define FE310_SPI2_HANDLER          PlicInterrupt7
+
+#define FE310_QSPI0_NUMBER          5
+#define FE310_SPI1_NUMBER           6
+#define FE310_SPI2_NUMBER           7
+
+/*
+ * GPIO pads, one source per pad starting from pad 0.
+ */
+#define FE310_GPIO0_FIRST_NUMBER    8
 /** @} */
 
 /*===========================================================================*/
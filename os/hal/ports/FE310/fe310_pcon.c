@@ -0,0 +1,258 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_pcon.c
+ * @brief   FE310 polled console code.
+ *
+ * @addtogroup FE310_PCON
+ * @{
+ */
+
+#include "hal.h"
+#include "fe310_gpio.h"
+
+#if (FE310_USE_PCON == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+#if (FE310_PCON_USE_EXCEPTION_DUMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Names of the registers saved by @p TrapEnter.
+ */
+static const char * const pcon_regnames[] = {
+  "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7",
+  "t0", "t1", "t2", "t3", "t4", "t5", "t6", "ra"
+};
+#endif
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Prints a name and a register value.
+ *
+ * @param[in] name      register name
+ * @param[in] value     register value
+ */
+static void pcon_put_reg(const char *name, uint32_t value) {
+
+  fe310PconPuts("  ");
+  fe310PconPuts(name);
+  fe310PconPuts(" = 0x");
+  fe310PconPutHex(value);
+  fe310PconPuts("\r\n");
+}
+
+/**
+ * @brief   Prints the trap CSRs.
+ */
+static void pcon_put_trap_csrs(void) {
+  uint32_t mcause, mepc, mtval, mstatus;
+
+  RISCV_CSR_READ(mcause, mcause);
+  RISCV_CSR_READ(mepc, mepc);
+  RISCV_CSR_READ(mtval, mtval);
+  RISCV_CSR_READ(mstatus, mstatus);
+  pcon_put_reg("mcause", mcause);
+  pcon_put_reg("mepc", mepc);
+  pcon_put_reg("mtval", mtval);
+  pcon_put_reg("mstatus", mstatus);
+}
+
+#if (FE310_PCON_USE_EXCEPTION_DUMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Dumps an unhandled trap and halts.
+ *
+ * @param[in] ctxp      registers saved by @p TrapEnter
+ */
+static void __attribute__((noreturn, used))
+pcon_exception(const struct port_extctx *ctxp) {
+  const uint32_t *regs = (const uint32_t *)ctxp;
+  uint32_t mcause;
+  unsigned i;
+
+  RISCV_CSR_READ(mcause, mcause);
+  fe310PconPuts((mcause & 0x80000000U) != 0U ?
+                "\r\n*** unhandled interrupt\r\n" :
+                "\r\n*** unhandled exception\r\n");
+  pcon_put_trap_csrs();
+  for (i = 0; i < sizeof (pcon_regnames) / sizeof (pcon_regnames[0]); i++) {
+    pcon_put_reg(pcon_regnames[i], regs[i]);
+  }
+  pcon_put_reg("sp", (uint32_t)ctxp + sizeof (struct port_extctx));
+  fe310PconFlush();
+
+  while (true) {
+  }
+}
+#endif
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+#if (FE310_PCON_USE_EXCEPTION_DUMP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Unhandled exceptions and interrupts entry.
+ * @details Replaces the weak handler in @p vectors.S, the stack pointer
+ *          points to the registers saved by @p TrapEnter.
+ */
+void __attribute__((naked)) _unhandled_exception(void) {
+
+  asm volatile ("mv     a0, sp\n\t"
+                "j      pcon_exception");
+}
+#endif
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Configures the console UART.
+ * @details Programs the bit rate, enables the transmitter and routes the
+ *          TX pin. The clocks must already be initialized, it can be
+ *          called from @p __early_init() after @p fe310_clock_init().
+ * @note    Starting the serial driver on the same UART overrides these
+ *          settings, the console keeps working with them.
+ *
+ * @api
+ */
+void fe310PconInit(void) {
+
+  FE310_PCON_UART->DIV = UART_DIV_DIV(UART_DIV_ROUND(FE310_CORECLK,
+                                                     FE310_PCON_BITRATE));
+  FE310_PCON_UART->TXCTRL = UART_TXCTRL_TXEN | UART_TXCTRL_TXCNT(1);
+
+  GPIO0->IOF_SEL &= ~(1U << FE310_PCON_TX_PIN);
+  GPIO0->IOF_EN  |= (1U << FE310_PCON_TX_PIN);
+}
+
+/**
+ * @brief   Writes a character.
+ * @details Busy waits for room in the TX FIFO.
+ *
+ * @param[in] c         the character
+ *
+ * @api
+ */
+void fe310PconPutChar(char c) {
+
+  while ((FE310_PCON_UART->TXDATA & UART_TXDATA_FULL) != 0U) {
+  }
+  FE310_PCON_UART->TXDATA = UART_TXDATA_DATA((uint8_t)c);
+}
+
+/**
+ * @brief   Writes a string.
+ *
+ * @param[in] s         the zero terminated string
+ *
+ * @api
+ */
+void fe310PconPuts(const char *s) {
+
+  while (*s != '\0') {
+    fe310PconPutChar(*s++);
+  }
+}
+
+/**
+ * @brief   Writes a value as eight hexadecimal digits.
+ *
+ * @param[in] n         the value
+ *
+ * @api
+ */
+void fe310PconPutHex(uint32_t n) {
+  int i;
+
+  for (i = 28; i >= 0; i -= 4) {
+    fe310PconPutChar("0123456789abcdef"[(n >> i) & 15U]);
+  }
+}
+
+/**
+ * @brief   Writes a value in decimal.
+ *
+ * @param[in] n         the value
+ *
+ * @api
+ */
+void fe310PconPutDec(uint32_t n) {
+  char buf[10];
+  int i = 0;
+
+  do {
+    buf[i++] = (char)('0' + (n % 10U));
+    n /= 10U;
+  } while (n > 0U);
+  while (i > 0) {
+    fe310PconPutChar(buf[--i]);
+  }
+}
+
+/**
+ * @brief   Waits for the TX FIFO to become empty.
+ * @note    The TX watermark is set to one, only call it when the serial
+ *          driver is no longer going to run.
+ *
+ * @api
+ */
+void fe310PconFlush(void) {
+  fe310_uart_t *u = FE310_PCON_UART;
+
+  u->TXCTRL = (u->TXCTRL & ~UART_TXCTRL_TXCNT(UART_TXCTRL_TXCNT_MASK)) |
+              UART_TXCTRL_TXCNT(1);
+  while ((u->IP & UART_IP_TXWM) == 0U) {
+  }
+}
+
+/**
+ * @brief   Prints the halt reason and the trap CSRs.
+ * @details Meant for @p CH_CFG_SYSTEM_HALT_HOOK, the trap CSRs describe
+ *          the last trap taken, the one being served if the system halted
+ *          within an ISR.
+ *
+ * @param[in] reason    the halt reason, can be @p NULL
+ *
+ * @special
+ */
+void fe310PconHalt(const char *reason) {
+
+  fe310PconPuts("\r\n*** halted: ");
+  fe310PconPuts(reason != NULL ? reason : "unknown");
+  fe310PconPuts("\r\n");
+  pcon_put_reg("ra", (uint32_t)__builtin_return_address(0));
+  pcon_put_trap_csrs();
+  fe310PconFlush();
+}
+
+#endif /* FE310_USE_PCON == TRUE */
+
+/** @} */
@@ -0,0 +1,131 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_pcon.h
+ * @brief   FE310 polled console header.
+ * @details Synchronous output on an UART that needs neither interrupts,
+ *          queues nor initialized RAM. It can be used from
+ *          @p __early_init(), from @p CH_CFG_SYSTEM_HALT_HOOK and from the
+ *          exception path, where the serial driver is not usable.
+ *
+ * @addtogroup FE310_PCON
+ * @{
+ */
+
+#ifndef FE310_PCON_H
+#define FE310_PCON_H
+
+#include "fe310_uart.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Polled console enable switch.
+ */
+#if !defined(FE310_USE_PCON) || defined(__DOXYGEN__)
+#define FE310_USE_PCON                      FALSE
+#endif
+
+/**
+ * @brief   UART used by the polled console.
+ */
+#if !defined(FE310_PCON_UART) || defined(__DOXYGEN__)
+#define FE310_PCON_UART                     UART0
+#endif
+
+/**
+ * @brief   GPIO0 pin routed to the console UART TX by @p fe310PconInit().
+ * @details 17 for UART0, 18 for UART1.
+ */
+#if !defined(FE310_PCON_TX_PIN) || defined(__DOXYGEN__)
+#define FE310_PCON_TX_PIN                   17
+#endif
+
+/**
+ * @brief   Console bit rate.
+ * @details Defaults to the serial driver rate so the same terminal can
+ *          read both.
+ */
+#if !defined(FE310_PCON_BITRATE) || defined(__DOXYGEN__)
+#if defined(SERIAL_DEFAULT_BITRATE)
+#define FE310_PCON_BITRATE                  SERIAL_DEFAULT_BITRATE
+#else
+#define FE310_PCON_BITRATE                  38400
+#endif
+#endif
+
+/**
+ * @brief   Exception dump switch.
+ * @details If set to @p TRUE unhandled exceptions and interrupts print
+ *          their cause and the saved registers before halting.
+ */
+#if !defined(FE310_PCON_USE_EXCEPTION_DUMP) || defined(__DOXYGEN__)
+#define FE310_PCON_USE_EXCEPTION_DUMP       TRUE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (FE310_USE_PCON == TRUE) &&                                             \
+    ((UART_DIV_ROUND(FE310_CORECLK, FE310_PCON_BITRATE) < UART_DIV_MIN) ||  \
+     (UART_DIV_ROUND(FE310_CORECLK, FE310_PCON_BITRATE) > UART_DIV_DIV_MASK))
+#error "FE310_PCON_BITRATE cannot be obtained from FE310_CORECLK"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (FE310_USE_PCON == TRUE) || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void fe310PconInit(void);
+  void fe310PconPutChar(char c);
+  void fe310PconPuts(const char *s);
+  void fe310PconPutHex(uint32_t n);
+  void fe310PconPutDec(uint32_t n);
+  void fe310PconFlush(void);
+  void fe310PconHalt(const char *reason);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+#endif /* FE310_PCON_H */
+
+/** @} */
@@ -0,0 +1,331 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_pinmap.hpp
+ * @brief   FE310 compile time pin map.
+ * @details The board pin map is declared as a list of constant pin
+ *          specifications, the GPIO register values are computed by the
+ *          compiler and written once at startup:
+ *          @code
+ *          using BoardPins = fe310::PinMap<
+ *            fe310::iof::uart0_rx,
+ *            fe310::iof::uart0_tx,
+ *            fe310::pin(5, PAL_MODE_OUTPUT_PUSHPULL, PAL_HIGH),
+ *            fe310::pin(9, PAL_MODE_INPUT_PULLUP)>;
+ *
+ *          void boardInit(void) {
+ *
+ *            BoardPins::apply(GPIO0);
+ *          }
+ *          @endcode
+ *          A pad listed twice, or an alternate function the pad does not
+ *          have, fails the build. The modes are the @p PAL_MODE_xxx
+ *          values accepted by @p palSetPadMode() and are programmed the
+ *          same way.
+ * @note    Requires C++14.
+ *
+ * @addtogroup FE310_PINMAP
+ * @{
+ */
+
+#ifndef FE310_PINMAP_HPP
+#define FE310_PINMAP_HPP
+
+#include "hal.h"
+
+#if __cplusplus < 201402L
+#error "fe310_pinmap.hpp requires C++14"
+#endif
+
+namespace fe310 {
+
+  /*=========================================================================*/
+  /* Pin specifications.                                                   */
+  /*=========================================================================*/
+
+  /**
+   * @brief   Encoded pin specification.
+   * @details Pad in bits 24..31, initial output level in bit 16, PAL mode
+   *          in bits 0..15.
+   */
+  typedef uint32_t pinspec_t;
+
+  /**
+   * @brief   Builds a pin specification.
+   *
+   * @param[in] pad       pad number within @p GPIO0
+   * @param[in] mode      a @p PAL_MODE_xxx value
+   * @param[in] level     initial output latch, @p PAL_LOW or @p PAL_HIGH
+   * @return              The pin specification.
+   */
+  constexpr pinspec_t pin(unsigned pad, iomode_t mode,
+                          unsigned level = PAL_LOW) {
+
+    return ((pinspec_t)pad << 24) | ((pinspec_t)(level != PAL_LOW) << 16) |
+           (pinspec_t)mode;
+  }
+
+  /**
+   * @brief   Pads with an IOF0 function on the FE310-G002.
+   */
+  constexpr uint32_t iof0_pads = 0xFC8737FCU;
+
+  /**
+   * @brief   Pads with an IOF1 function on the FE310-G002.
+   */
+  constexpr uint32_t iof1_pads = 0x00783C0FU;
+
+  /**
+   * @brief   FE310-G002 alternate functions.
+   * @details Each signal is wired to a single pad.
+   */
+  namespace iof {
+    constexpr pinspec_t spi1_cs0  = pin(2,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_dq0  = pin(3,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_dq1  = pin(4,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_sck  = pin(5,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_dq2  = pin(6,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_dq3  = pin(7,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_cs1  = pin(8,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_cs2  = pin(9,  PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi1_cs3  = pin(10, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t i2c0_sda  = pin(12, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t i2c0_scl  = pin(13, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t uart0_rx  = pin(16, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t uart0_tx  = pin(17, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t uart1_tx  = pin(18, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t uart1_rx  = pin(23, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi2_cs0  = pin(26, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi2_dq0  = pin(27, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi2_dq1  = pin(28, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi2_sck  = pin(29, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi2_dq2  = pin(30, PAL_MODE_ALTERNATE(0));
+    constexpr pinspec_t spi2_dq3  = pin(31, PAL_MODE_ALTERNATE(0));
+
+    constexpr pinspec_t pwm0_0    = pin(0,  PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm0_1    = pin(1,  PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm0_2    = pin(2,  PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm0_3    = pin(3,  PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm2_0    = pin(10, PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm2_1    = pin(11, PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm2_2    = pin(12, PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm2_3    = pin(13, PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm1_1    = pin(19, PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm1_0    = pin(20, PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm1_2    = pin(21, PAL_MODE_ALTERNATE(1));
+    constexpr pinspec_t pwm1_3    = pin(22, PAL_MODE_ALTERNATE(1));
+  }
+
+  /*=========================================================================*/
+  /* Register values computation.                                          */
+  /*=========================================================================*/
+
+  namespace detail {
+
+    constexpr unsigned pad(pinspec_t s) {
+
+      return s >> 24;
+    }
+
+    constexpr iomode_t mode(pinspec_t s) {
+
+      return s & 0xFFFFU;
+    }
+
+    constexpr bool high(pinspec_t s) {
+
+      return (s & (1U << 16)) != 0U;
+    }
+
+    constexpr uint32_t moder(pinspec_t s) {
+
+      return mode(s) & PAL_FE310_MODE_MASK;
+    }
+
+    /**
+     * @brief   GPIO registers written by a pin map.
+     */
+    enum class reg {
+      input_en,
+      output_en,
+      output_val,
+      pullup_en,
+      drive_str,
+      iof_en,
+      iof_sel
+    };
+
+    /**
+     * @brief   Tells if a pad has to be set in a register.
+     * @note    Mirrors @p _pal_lld_setgroupmode().
+     */
+    constexpr bool isset(pinspec_t s, reg r) {
+
+      switch (r) {
+      case reg::input_en:
+        return (moder(s) == PAL_FE310_MODE_INPUT) ||
+               (moder(s) == PAL_FE310_MODE_OUTPUT);
+      case reg::output_en:
+        return moder(s) == PAL_FE310_MODE_OUTPUT;
+      case reg::output_val:
+        return high(s);
+      case reg::pullup_en:
+        return (mode(s) & PAL_FE310_PUPDR_MASK) != 0U;
+      case reg::drive_str:
+        return (mode(s) & PAL_FE310_OSPEED_MASK) != 0U;
+      case reg::iof_en:
+        return moder(s) == PAL_FE310_MODE_ALTERNATE;
+      case reg::iof_sel:
+        return (moder(s) == PAL_FE310_MODE_ALTERNATE) &&
+               ((mode(s) & PAL_FE310_ALTERNATE_MASK) != 0U);
+      }
+      return false;
+    }
+
+    template <pinspec_t... Specs>
+    constexpr uint32_t value(reg r) {
+      const pinspec_t specs[] = {Specs..., 0U};
+      uint32_t v = 0U;
+
+      for (unsigned i = 0U; i < sizeof...(Specs); i++) {
+        if (isset(specs[i], r))
+          v |= 1U << pad(specs[i]);
+      }
+      return v;
+    }
+
+    template <pinspec_t... Specs>
+    constexpr bool pads_valid(void) {
+      const pinspec_t specs[] = {Specs..., 0U};
+
+      for (unsigned i = 0U; i < sizeof...(Specs); i++) {
+        if (pad(specs[i]) >= PAL_IOPORTS_WIDTH)
+          return false;
+      }
+      return true;
+    }
+
+    template <pinspec_t... Specs>
+    constexpr bool pads_unique(void) {
+      const pinspec_t specs[] = {Specs..., 0U};
+      uint32_t seen = 0U;
+
+      for (unsigned i = 0U; i < sizeof...(Specs); i++) {
+        if ((seen & (1U << pad(specs[i]))) != 0U)
+          return false;
+        seen |= 1U << pad(specs[i]);
+      }
+      return true;
+    }
+
+    template <pinspec_t... Specs>
+    constexpr bool iofs_valid(void) {
+      const pinspec_t specs[] = {Specs..., 0U};
+
+      for (unsigned i = 0U; i < sizeof...(Specs); i++) {
+        if (isset(specs[i], reg::iof_en)) {
+          uint32_t pads = isset(specs[i], reg::iof_sel) ? iof1_pads :
+                                                          iof0_pads;
+          if ((mode(specs[i]) & PAL_FE310_ALTERNATE_MASK) >
+              PAL_FE310_ALTERNATE(1U))
+            return false;
+          if ((pads & (1U << pad(specs[i]))) == 0U)
+            return false;
+        }
+      }
+      return true;
+    }
+
+    template <pinspec_t... Specs>
+    constexpr bool modes_valid(void) {
+      const pinspec_t specs[] = {Specs..., 0U};
+
+      for (unsigned i = 0U; i < sizeof...(Specs); i++) {
+        if ((specs[i] & 0x00FE0000U) != 0U)
+          return false;
+      }
+      return true;
+    }
+  }
+
+  /*=========================================================================*/
+  /* Pin map.                                                              */
+  /*=========================================================================*/
+
+  /**
+   * @brief   Board pin map.
+   * @details Pads not listed are left in their reset state, unconnected
+   *          with the pull up disabled.
+   *
+   * @tparam Specs        pin specifications, see @p pin() and @p iof
+   */
+  template <pinspec_t... Specs>
+  struct PinMap {
+    static_assert(detail::pads_valid<Specs...>(),
+                  "fe310::PinMap: pad number out of range");
+    static_assert(detail::modes_valid<Specs...>(),
+                  "fe310::PinMap: invalid mode or level");
+    static_assert(detail::pads_unique<Specs...>(),
+                  "fe310::PinMap: pad configured more than once");
+    static_assert(detail::iofs_valid<Specs...>(),
+                  "fe310::PinMap: alternate function not available on pad");
+
+    static constexpr uint32_t input_en =
+      detail::value<Specs...>(detail::reg::input_en);
+    static constexpr uint32_t output_en =
+      detail::value<Specs...>(detail::reg::output_en);
+    static constexpr uint32_t output_val =
+      detail::value<Specs...>(detail::reg::output_val);
+    static constexpr uint32_t pullup_en =
+      detail::value<Specs...>(detail::reg::pullup_en);
+    static constexpr uint32_t drive_str =
+      detail::value<Specs...>(detail::reg::drive_str);
+    static constexpr uint32_t iof_en =
+      detail::value<Specs...>(detail::reg::iof_en);
+    static constexpr uint32_t iof_sel =
+      detail::value<Specs...>(detail::reg::iof_sel);
+
+    /**
+     * @brief   Programs the whole port.
+     * @details One store per register. The IOFs that are going away or
+     *          changing selection are released first, then the output
+     *          latch, the pull ups, the drive strength and the IOF
+     *          selection are settled before the pads are enabled, so no
+     *          pad is driven with a stale value or function. IOFs already
+     *          in place, like a console TX, keep running.
+     * @note    Meant for @p boardInit(), other drivers must not be
+     *          using the port.
+     *
+     * @param[in] port      the GPIO port
+     */
+    static void apply(ioportid_t port) {
+
+      port->IOF_EN     = port->IOF_EN & iof_en & ~(port->IOF_SEL ^ iof_sel);
+      port->OUTPUT_VAL = output_val;
+      port->PULLUP_EN  = pullup_en;
+      port->DRIVE_STR  = drive_str;
+      port->IOF_SEL    = iof_sel;
+      port->INPUT_EN   = input_en;
+      port->OUTPUT_EN  = output_en;
+      port->IOF_EN     = iof_en;
+    }
+  };
+}
+
+#endif /* FE310_PINMAP_HPP */
+
+/** @} */
@@ -0,0 +1,268 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_spi.h
+ * @brief   FE310 SPI units common header.
+ *
+ * @addtogroup FE310_SPI
+ * @{
+ */
+
+#ifndef FE310_SPI_H
+#define FE310_SPI_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    SPI definitions
+ * @{
+ */
+#define QSPI0                           ((fe310_spi_t *)0x10014000)
+#define SPI1                            ((fe310_spi_t *)0x10024000)
+#define SPI2                            ((fe310_spi_t *)0x10034000)
+#define SPI_FIFO_SIZE                   8
+/** @} */
+
+/**
+ * @name    SCKDIV register definitions
+ * @{
+ */
+#define SPI_SCKDIV_DIV_SHIFT            0
+#define SPI_SCKDIV_DIV_MASK             0xFFF
+#define SPI_SCKDIV_DIV(n)               (((n) & SPI_SCKDIV_DIV_MASK) << SPI_SCKDIV_DIV_SHIFT)
+/** @} */
+
+/**
+ * @name    SCKMODE register definitions
+ * @{
+ */
+#define SPI_SCKMODE_PHA                 (1 << 0)
+#define SPI_SCKMODE_POL                 (1 << 1)
+/** @} */
+
+/**
+ * @name    CSMODE register definitions
+ * @{
+ */
+#define SPI_CSMODE_AUTO                 0
+#define SPI_CSMODE_HOLD                 2
+#define SPI_CSMODE_OFF                  3
+/** @} */
+
+/**
+ * @name    DELAY0 register definitions
+ * @{
+ */
+#define SPI_DELAY0_CSSCK_SHIFT          0
+#define SPI_DELAY0_CSSCK_MASK           0xFF
+#define SPI_DELAY0_CSSCK(n)             (((n) & SPI_DELAY0_CSSCK_MASK) << SPI_DELAY0_CSSCK_SHIFT)
+
+#define SPI_DELAY0_SCKCS_SHIFT          16
+#define SPI_DELAY0_SCKCS_MASK           0xFF
+#define SPI_DELAY0_SCKCS(n)             (((n) & SPI_DELAY0_SCKCS_MASK) << SPI_DELAY0_SCKCS_SHIFT)
+/** @} */
+
+/**
+ * @name    DELAY1 register definitions
+ * @{
+ */
+#define SPI_DELAY1_INTERCS_SHIFT        0
+#define SPI_DELAY1_INTERCS_MASK         0xFF
+#define SPI_DELAY1_INTERCS(n)           (((n) & SPI_DELAY1_INTERCS_MASK) << SPI_DELAY1_INTERCS_SHIFT)
+
+#define SPI_DELAY1_INTERXFR_SHIFT       16
+#define SPI_DELAY1_INTERXFR_MASK        0xFF
+#define SPI_DELAY1_INTERXFR(n)          (((n) & SPI_DELAY1_INTERXFR_MASK) << SPI_DELAY1_INTERXFR_SHIFT)
+/** @} */
+
+/**
+ * @name    FMT register definitions
+ * @{
+ */
+#define SPI_FMT_PROTO_MASK              (3 << 0)
+#define SPI_FMT_PROTO_SINGLE            (0 << 0)
+#define SPI_FMT_PROTO_DUAL              (1 << 0)
+#define SPI_FMT_PROTO_QUAD              (2 << 0)
+
+#define SPI_FMT_ENDIAN_MSB              (0 << 2)
+#define SPI_FMT_ENDIAN_LSB              (1 << 2)
+
+#define SPI_FMT_DIR_RX                  (0 << 3)
+#define SPI_FMT_DIR_TX                  (1 << 3)
+
+#define SPI_FMT_LEN_SHIFT               16
+#define SPI_FMT_LEN_MASK                0xF
+#define SPI_FMT_LEN(n)                  (((n) & SPI_FMT_LEN_MASK) << SPI_FMT_LEN_SHIFT)
+/** @} */
+
+/**
+ * @name    TXDATA register definitions
+ * @{
+ */
+#define SPI_TXDATA_DATA_SHIFT           0
+#define SPI_TXDATA_DATA_MASK            0xFF
+#define SPI_TXDATA_DATA(n)              (((n) & SPI_TXDATA_DATA_MASK) << SPI_TXDATA_DATA_SHIFT)
+
+#define SPI_TXDATA_FULL                 (1U << 31)
+/** @} */
+
+/**
+ * @name    RXDATA register definitions
+ * @{
+ */
+#define SPI_RXDATA_DATA_SHIFT           0
+#define SPI_RXDATA_DATA_MASK            0xFF
+#define SPI_RXDATA_DATA(n)              (((n) & SPI_RXDATA_DATA_MASK) << SPI_RXDATA_DATA_SHIFT)
+
+#define SPI_RXDATA_EMPTY                (1U << 31)
+/** @} */
+
+/**
+ * @name    TXMARK and RXMARK registers definitions
+ * @{
+ */
+#define SPI_MARK_MASK                   0x7
+#define SPI_MARK(n)                     ((n) & SPI_MARK_MASK)
+/** @} */
+
+/**
+ * @name    FCTRL register definitions, QSPI0 only
+ * @{
+ */
+#define SPI_FCTRL_EN                    (1 << 0)
+/** @} */
+
+/**
+ * @name    FFMT register definitions, QSPI0 only
+ * @{
+ */
+#define SPI_FFMT_CMD_EN                 (1 << 0)
+
+#define SPI_FFMT_ADDR_LEN_SHIFT         1
+#define SPI_FFMT_ADDR_LEN_MASK          0x7
+#define SPI_FFMT_ADDR_LEN(n)            (((n) & SPI_FFMT_ADDR_LEN_MASK) << SPI_FFMT_ADDR_LEN_SHIFT)
+
+#define SPI_FFMT_PAD_CNT_SHIFT          4
+#define SPI_FFMT_PAD_CNT_MASK           0xF
+#define SPI_FFMT_PAD_CNT(n)             (((n) & SPI_FFMT_PAD_CNT_MASK) << SPI_FFMT_PAD_CNT_SHIFT)
+
+#define SPI_FFMT_CMD_PROTO_SHIFT        8
+#define SPI_FFMT_CMD_PROTO(p)           ((p) << SPI_FFMT_CMD_PROTO_SHIFT)
+
+#define SPI_FFMT_ADDR_PROTO_SHIFT       10
+#define SPI_FFMT_ADDR_PROTO(p)          ((p) << SPI_FFMT_ADDR_PROTO_SHIFT)
+
+#define SPI_FFMT_DATA_PROTO_SHIFT       12
+#define SPI_FFMT_DATA_PROTO(p)          ((p) << SPI_FFMT_DATA_PROTO_SHIFT)
+
+#define SPI_FFMT_CMD_CODE_SHIFT         16
+#define SPI_FFMT_CMD_CODE_MASK          0xFF
+#define SPI_FFMT_CMD_CODE(n)            (((n) & SPI_FFMT_CMD_CODE_MASK) << SPI_FFMT_CMD_CODE_SHIFT)
+
+#define SPI_FFMT_PAD_CODE_SHIFT         24
+#define SPI_FFMT_PAD_CODE_MASK          0xFF
+#define SPI_FFMT_PAD_CODE(n)            (((n) & SPI_FFMT_PAD_CODE_MASK) << SPI_FFMT_PAD_CODE_SHIFT)
+/** @} */
+
+/**
+ * @name    IE register definitions
+ * @{
+ */
+#define SPI_IE_TXWM                     (1 << 0)
+#define SPI_IE_RXWM                     (1 << 1)
+/** @} */
+
+/**
+ * @name    IP register definitions
+ * @{
+ */
+#define SPI_IP_TXWM                     (1 << 0)
+#define SPI_IP_RXWM                     (1 << 1)
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   FE310 SPI registers block.
+ */
+typedef struct {
+
+  volatile uint32_t   SCKDIV;
+  volatile uint32_t   SCKMODE;
+  volatile uint32_t   _R0[2];
+  volatile uint32_t   CSID;
+  volatile uint32_t   CSDEF;
+  volatile uint32_t   CSMODE;
+  volatile uint32_t   _R1[3];
+  volatile uint32_t   DELAY0;
+  volatile uint32_t   DELAY1;
+  volatile uint32_t   _R2[4];
+  volatile uint32_t   FMT;
+  volatile uint32_t   _R3;
+  volatile uint32_t   TXDATA;
+  volatile uint32_t   RXDATA;
+  volatile uint32_t   TXMARK;
+  volatile uint32_t   RXMARK;
+  volatile uint32_t   _R4[2];
+  volatile uint32_t   FCTRL;
+  volatile uint32_t   FFMT;
+  volatile uint32_t   _R5[2];
+  volatile uint32_t   IE;
+  volatile uint32_t   IP;
+} fe310_spi_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Divisor for a maximum SCK frequency.
+ * @details SCK is clk / (2 * (div + 1)), the divisor is rounded up so the
+ *          frequency does not exceed @p hz.
+ *
+ * @param[in] clk       SPI input clock
+ * @param[in] hz        maximum SCK frequency
+ */
+#define SPI_SCKDIV_FOR(clk, hz)         ((((clk) + (2U * (hz)) - 1U) / (2U * (hz))) - 1U)
+
+/**
+ * @brief   SCK frequency obtained with a divisor.
+ *
+ * @param[in] clk       SPI input clock
+ * @param[in] div       divisor
+ */
+#define SPI_SCKDIV_HZ(clk, div)         ((clk) / (2U * ((div) + 1U)))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#endif /* FE310_SPI_H */
+
+/** @} */
@@ -35,6 +35,7 @@
  */
 #define UART0                           ((fe310_uart_t *)0x10013000)
 #define UART1                           ((fe310_uart_t *)0x10023000)
+#define UART_FIFO_SIZE                  8
 /** @} */
 
 /**
@@ -110,6 +111,11 @@
 #define UART_DIV_DIV(n)                 (((n) & UART_DIV_DIV_MASK) << UART_DIV_DIV_SHIFT)
 /** @} */
 
+/**
+ * @brief   Minimum divisor, the receiver oversamples each bit 16 times.
+ */
+#define UART_DIV_MIN                    16
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -140,6 +146,35 @@ typedef struct {
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Divisor for a bit rate, rounded to the nearest value.
+ *
+ * @param[in] clk       UART input clock
+ * @param[in] baud      required bit rate
+ */
+#define UART_DIV_ROUND(clk, baud)       ((((clk) + ((baud) / 2U)) / (baud)) - 1U)
+
+/**
+ * @brief   Bit rate obtained with a divisor.
+ *
+ * @param[in] clk       UART input clock
+ * @param[in] div       divisor
+ */
+#define UART_DIV_BAUD(clk, div)         ((clk) / ((div) + 1U))
+
+/**
+ * @brief   Bit rate error of the rounded divisor, in tenths of percent.
+ * @note    Usable in preprocessor expressions.
+ *
+ * @param[in] clk       UART input clock
+ * @param[in] baud      required bit rate
+ */
+#define UART_BAUD_ERROR(clk, baud)                                          \
+  (((UART_DIV_BAUD(clk, UART_DIV_ROUND(clk, baud)) > (baud)) ?              \
+    (UART_DIV_BAUD(clk, UART_DIV_ROUND(clk, baud)) - (baud)) :              \
+    ((baud) - UART_DIV_BAUD(clk, UART_DIV_ROUND(clk, baud)))) * 1000U /     \
+   (baud))
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
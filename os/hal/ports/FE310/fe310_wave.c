@@ -0,0 +1,193 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_wave.c
+ * @brief   FE310 GPIO waveform engine code.
+ *
+ * @addtogroup FE310_WAVE
+ * @{
+ */
+
+#include "hal.h"
+#include "fe310_wave.h"
+
+#if (FE310_USE_WAVE == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Edges loop attributes.
+ */
+#define WAVE_ITIM_CODE  __attribute__((noinline, section(FE310_WAVE_SECTION)))
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Edges loop parameters.
+ * @details Everything the loop reads lives in RAM, a read from the XIP
+ *          flash would stall it.
+ */
+typedef struct {
+  volatile uint32_t         *out;
+  uint32_t                  on;
+  uint32_t                  off;
+  uint32_t                  high[2];
+  uint32_t                  low[2];
+  uint32_t                  tail;
+  uint32_t                  msb;
+} wave_run_t;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Emits the edges.
+ * @details Each edge is written at an absolute @p mcycle value, the bit
+ *          decoding of the next phase overlaps the current one so the
+ *          phases do not accumulate errors.
+ * @note    Runs with interrupts masked, it must not call any code outside
+ *          its section.
+ *
+ * @param[in] wrp       loop parameters, in RAM
+ * @param[in] data      bits to be sent, in RAM
+ * @param[in] nbits     number of bits
+ * @return              The largest delay of an edge, in cycles.
+ */
+static uint32_t WAVE_ITIM_CODE wave_run(const wave_run_t *wrp,
+                                        const uint8_t *data, size_t nbits) {
+  volatile uint32_t *out = wrp->out;
+  uint32_t on = wrp->on, off = wrp->off;
+  uint32_t edge, now, late, worst = 0U;
+  size_t i;
+
+  RISCV_CSR_READ(edge, mcycle);
+  edge += FE310_WAVE_LEAD_CYCLES;
+
+  for (i = 0U; i < nbits; i++) {
+    uint32_t byte = data[i >> 3];
+    uint32_t bit = wrp->msb != 0U ? (byte >> (7U - (i & 7U))) & 1U :
+                                    (byte >> (i & 7U)) & 1U;
+
+    do {
+      RISCV_CSR_READ(now, mcycle);
+    } while ((int32_t)(now - edge) < 0);
+    *out = on;
+    RISCV_CSR_READ(now, mcycle);
+    late = now - edge;
+    worst = late > worst ? late : worst;
+    edge += wrp->high[bit];
+
+    do {
+      RISCV_CSR_READ(now, mcycle);
+    } while ((int32_t)(now - edge) < 0);
+    *out = off;
+    RISCV_CSR_READ(now, mcycle);
+    late = now - edge;
+    worst = late > worst ? late : worst;
+    edge += wrp->low[bit];
+  }
+
+  /* The line stays in the off state for the last low phase and the tail.*/
+  edge += wrp->tail;
+  do {
+    RISCV_CSR_READ(now, mcycle);
+  } while ((int32_t)(now - edge) < 0);
+
+  return worst;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Sends a waveform.
+ * @details The line is driven through stores of the whole @p OUTPUT_VAL
+ *          register, computed on entry. The line must be already
+ *          programmed as an output and the other outputs of the port must
+ *          not be changed by other cores or DMA during the transfer.
+ * @note    Interrupts are masked in @p mstatus.MIE for the whole transfer
+ *          including the tail, the PLIC threshold alone would still let
+ *          the timer and software interrupts through when
+ *          @p PORT_RISCV_SIMPLIFIED_PRIORITY is @p FALSE. Keep transfers
+ *          short. The system time keeps running and the interrupts that
+ *          became pending are served on return.
+ * @note    Delays up to a few cycles are the store latency and the wait
+ *          loop granularity. Larger ones mean that an edge has been
+ *          missed, for example because a phase is shorter than the loop
+ *          body.
+ *
+ * @param[in] line      output line
+ * @param[in] wtp       bit timing
+ * @param[in] data      bits to be sent, at least @p nbits / 8 bytes, it must
+ *                      not be in flash
+ * @param[in] nbits     number of bits to be sent
+ * @return              The largest delay of an edge from its scheduled
+ *                      time, in core clock cycles.
+ *
+ * @api
+ */
+uint32_t fe310WaveSend(ioline_t line, const fe310_wave_timing_t *wtp,
+                       const uint8_t *data, size_t nbits) {
+  ioportid_t port = PAL_PORT(line);
+  uint32_t mask = PAL_PORT_BIT(PAL_PAD(line));
+  wave_run_t wr;
+  uint32_t worst, sts;
+
+  osalDbgCheck((wtp != NULL) && ((data != NULL) || (nbits == 0U)));
+
+  wr.out     = &port->OUTPUT_VAL;
+  wr.high[0] = wtp->high[0];
+  wr.high[1] = wtp->high[1];
+  wr.low[0]  = wtp->low[0];
+  wr.low[1]  = wtp->low[1];
+  wr.tail    = wtp->tail;
+  wr.msb     = (wtp->flags & FE310_WAVE_LSB_FIRST) == 0U ? 1U : 0U;
+
+  osalSysLock();
+  if ((wtp->flags & FE310_WAVE_INVERTED) == 0U) {
+    wr.on  = port->OUTPUT_VAL | mask;
+    wr.off = port->OUTPUT_VAL & ~mask;
+  }
+  else {
+    wr.on  = port->OUTPUT_VAL & ~mask;
+    wr.off = port->OUTPUT_VAL | mask;
+  }
+  RISCV_CSR_READ_CLEAR_I(sts, mstatus, 8);
+  worst = wave_run(&wr, data, nbits);
+  RISCV_CSR_SET(mstatus, sts & 8U);
+  osalSysUnlock();
+
+  return worst;
+}
+
+#endif /* FE310_USE_WAVE == TRUE */
+
+/** @} */
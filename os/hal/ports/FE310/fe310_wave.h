@@ -0,0 +1,154 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_wave.h
+ * @brief   FE310 GPIO waveform engine header.
+ * @details Bit-banged serial protocols with cycle exact timing, like the
+ *          WS2812 LEDs or single wire sensors. Each bit is sent as a high
+ *          phase followed by a low phase whose durations depend on the
+ *          bit value. The edges are scheduled on absolute @p mcycle
+ *          values by a loop executing from the ITIM with interrupts
+ *          masked, so neither the I-cache nor the XIP flash can delay them.
+ *
+ * @addtogroup FE310_WAVE
+ * @{
+ */
+
+#ifndef FE310_WAVE_H
+#define FE310_WAVE_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Waveform flags
+ * @{
+ */
+/**
+ * @brief   Bits are sent least significant first.
+ */
+#define FE310_WAVE_LSB_FIRST                (1U << 0)
+
+/**
+ * @brief   Phases are sent low then high, for inverting line drivers.
+ */
+#define FE310_WAVE_INVERTED                 (1U << 1)
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Waveform engine enable switch.
+ */
+#if !defined(FE310_USE_WAVE) || defined(__DOXYGEN__)
+#define FE310_USE_WAVE                      FALSE
+#endif
+
+/**
+ * @brief   Section of the edges loop.
+ * @details The default places it in the ITIM, mapped as @p ram1 by the
+ *          linker script and loaded at startup. Use @p ".ramtext" to run
+ *          it from the DTIM where the ITIM is not mapped.
+ */
+#if !defined(FE310_WAVE_SECTION) || defined(__DOXYGEN__)
+#define FE310_WAVE_SECTION                  ".ram1_init.fe310_wave"
+#endif
+
+/**
+ * @brief   Cycles between the call and the first edge.
+ * @details Covers the setup of the edges loop, the first edge is reported
+ *          late if too small.
+ */
+#if !defined(FE310_WAVE_LEAD_CYCLES) || defined(__DOXYGEN__)
+#define FE310_WAVE_LEAD_CYCLES              64
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (HAL_USE_PAL != TRUE) && (FE310_USE_WAVE == TRUE)
+#error "FE310_USE_WAVE requires HAL_USE_PAL"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Bit timing description.
+ * @details Durations are in core clock cycles, see @p FE310_WAVE_NS2C().
+ */
+typedef struct {
+  /**
+   * @brief   High phase duration, indexed by the bit value.
+   */
+  uint32_t                  high[2];
+  /**
+   * @brief   Low phase duration, indexed by the bit value.
+   */
+  uint32_t                  low[2];
+  /**
+   * @brief   Additional low time after the last bit, a latch or reset
+   *          pulse, can be zero.
+   */
+  uint32_t                  tail;
+  /**
+   * @brief   Waveform flags.
+   */
+  uint32_t                  flags;
+} fe310_wave_timing_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Nanoseconds to core clock cycles, rounded up.
+ *
+ * @param[in] ns        nanoseconds, up to one millisecond
+ */
+#define FE310_WAVE_NS2C(ns)                                                 \
+  ((uint32_t)((((ns) * ((FE310_CORECLK + 999999U) / 1000000U)) + 999U) /    \
+              1000U))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (FE310_USE_WAVE == TRUE) || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  uint32_t fe310WaveSend(ioline_t line, const fe310_wave_timing_t *wtp,
+                         const uint8_t *data, size_t nbits);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+#endif /* FE310_WAVE_H */
+
+/** @} */
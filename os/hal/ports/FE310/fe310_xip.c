@@ -0,0 +1,232 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_xip.c
+ * @brief   FE310 XIP flash read mode tuning code.
+ *
+ * @addtogroup FE310_XIP
+ * @{
+ */
+
+#include "hal.h"
+
+#if (FE310_USE_XIP == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Reconfiguration code attributes.
+ */
+#define XIP_RAM_CODE    __attribute__((noinline, section(FE310_XIP_SECTION)))
+
+/**
+ * @brief   Helpers inlined in the reconfiguration code.
+ */
+#define XIP_INLINE      static inline __attribute__((always_inline))
+
+/**
+ * @brief   FMT value of the programmed I/O commands.
+ */
+#define XIP_FMT_COMMAND (SPI_FMT_PROTO_SINGLE | SPI_FMT_ENDIAN_MSB |        \
+                         SPI_FMT_DIR_RX | SPI_FMT_LEN(8))
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Flash base, from the linker script.
+ */
+extern const uint32_t __flash0_base__[];
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Exchanges a byte with the flash.
+ *
+ * @param[in] b         byte to be sent
+ * @return              The byte received.
+ */
+XIP_INLINE uint32_t xip_xfer(uint32_t b) {
+  uint32_t rx;
+
+  QSPI0->TXDATA = b;
+  do {
+    rx = QSPI0->RXDATA;
+  } while ((rx & SPI_RXDATA_EMPTY) != 0U);
+
+  return rx & SPI_RXDATA_DATA_MASK;
+}
+
+/**
+ * @brief   Sends a command without data.
+ *
+ * @param[in] cmd       command code
+ */
+XIP_INLINE void xip_command(uint32_t cmd) {
+
+  QSPI0->CSMODE = SPI_CSMODE_HOLD;
+  (void) xip_xfer(cmd);
+  QSPI0->CSMODE = SPI_CSMODE_AUTO;
+}
+
+/**
+ * @brief   Reads the status register.
+ *
+ * @return              The status register.
+ */
+XIP_INLINE uint32_t xip_read_status(void) {
+  uint32_t sr;
+
+  QSPI0->CSMODE = SPI_CSMODE_HOLD;
+  (void) xip_xfer(XIP_CMD_READ_STATUS);
+  sr = xip_xfer(0xFF);
+  QSPI0->CSMODE = SPI_CSMODE_AUTO;
+
+  return sr;
+}
+
+/**
+ * @brief   Checksum of the test window, read through the memory map.
+ *
+ * @return              The checksum.
+ */
+XIP_INLINE uint32_t xip_checksum(void) {
+  const volatile uint32_t *p = __flash0_base__;
+  uint32_t sum = 0U;
+  size_t i;
+
+  for (i = 0U; i < FE310_XIP_TEST_SIZE / 4U; i++) {
+    sum = ((sum << 5) | (sum >> 27)) ^ p[i];
+  }
+
+  return sum;
+}
+
+/**
+ * @brief   Switches the memory mapped reads to the quad I/O command.
+ * @details The quad enable bit is set if needed, then the read mode is
+ *          switched and the test window is compared with the reference
+ *          read before. The previous setup is restored on any failure.
+ * @note    Runs with interrupts masked, it must not call any code outside
+ *          its section nor read constants from the flash.
+ *
+ * @return              The operation status.
+ * @retval false        if the previous setup has been restored.
+ * @retval true         if quad I/O reads are active.
+ */
+static bool XIP_RAM_CODE xip_tune(void) {
+  uint32_t sckdiv = QSPI0->SCKDIV, ffmt = QSPI0->FFMT;
+  uint32_t fmt = QSPI0->FMT, csmode = QSPI0->CSMODE;
+  uint32_t sum, sr, start, now;
+  bool ok;
+
+  /* Reference read with the boot setup.*/
+  sum = xip_checksum();
+
+  /* Programmed I/O from here, no flash fetch is possible.*/
+  QSPI0->FCTRL = 0U;
+  QSPI0->FMT   = XIP_FMT_COMMAND;
+  while ((QSPI0->RXDATA & SPI_RXDATA_EMPTY) == 0U) {
+  }
+
+  sr = xip_read_status();
+  if ((sr & FE310_XIP_QE_MASK) == 0U) {
+    xip_command(XIP_CMD_WRITE_ENABLE);
+    QSPI0->CSMODE = SPI_CSMODE_HOLD;
+    (void) xip_xfer(XIP_CMD_WRITE_STATUS);
+    (void) xip_xfer((sr & ~(XIP_STATUS_WIP | XIP_STATUS_WEL)) |
+                    FE310_XIP_QE_MASK);
+    QSPI0->CSMODE = SPI_CSMODE_AUTO;
+
+    RISCV_CSR_READ(start, mcycle);
+    do {
+      sr = xip_read_status();
+      RISCV_CSR_READ(now, mcycle);
+    } while (((sr & XIP_STATUS_WIP) != 0U) &&
+             ((now - start) < (uint32_t)FE310_XIP_WRITE_CYCLES));
+  }
+
+  /* A missing or busy flash reads as all ones.*/
+  ok = (sr & (XIP_STATUS_WIP | FE310_XIP_QE_MASK)) == FE310_XIP_QE_MASK;
+  if (ok) {
+    QSPI0->SCKDIV = SPI_SCKDIV_DIV(FE310_XIP_SCKDIV);
+    QSPI0->FFMT   = FE310_XIP_FFMT_QUAD;
+  }
+  QSPI0->FMT    = fmt;
+  QSPI0->CSMODE = csmode;
+  QSPI0->FCTRL  = SPI_FCTRL_EN;
+
+  /* Read back test, the window is fetched again in the new mode.*/
+  if (ok && (xip_checksum() != sum)) {
+    QSPI0->FCTRL  = 0U;
+    QSPI0->SCKDIV = sckdiv;
+    QSPI0->FFMT   = ffmt;
+    QSPI0->FCTRL  = SPI_FCTRL_EN;
+    ok = false;
+  }
+
+  return ok;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Switches the XIP flash to quad I/O reads.
+ * @details Called by @p hal_lld_init(). The flash is left in single lane
+ *          mode if it does not answer the status register read, if the
+ *          quad enable bit cannot be set or if the read back test fails.
+ * @note    The reconfiguration code runs from @p FE310_XIP_SECTION, the
+ *          RAM areas must be initialized, it cannot be called from
+ *          @p __early_init().
+ * @note    The SCK divisor is computed from @p FE310_CORECLK, the clock
+ *          must not be changed afterwards.
+ *
+ * @return              The operation status.
+ * @retval false        if single lane reads have been kept.
+ * @retval true         if quad I/O reads are active.
+ *
+ * @init
+ */
+bool fe310XipInit(void) {
+  uint32_t sts;
+  bool ok;
+
+  RISCV_CSR_READ_CLEAR_I(sts, mstatus, 8);
+  ok = xip_tune();
+  RISCV_CSR_SET(mstatus, sts & 8U);
+
+  return ok;
+}
+
+#endif /* FE310_USE_XIP == TRUE */
+
+/** @} */
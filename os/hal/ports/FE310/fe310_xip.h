@@ -0,0 +1,236 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fe310_xip.h
+ * @brief   FE310 XIP flash read mode tuning header.
+ * @details The boot ROM leaves QSPI0 fetching with the single lane
+ *          @p 0x03 read command. @p fe310XipInit() switches the memory
+ *          mapped reads to the quad I/O fast read command @p 0xEB, with
+ *          an SCK derived from @p FE310_CORECLK, and falls back to the
+ *          previous setup if a read back of the flash does not match.
+ *
+ * @addtogroup FE310_XIP
+ * @{
+ */
+
+#ifndef FE310_XIP_H
+#define FE310_XIP_H
+
+#include "fe310_spi.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Memory mapped flash window
+ * @{
+ */
+#define FE310_XIP_BASE                  0x20000000U
+#define FE310_XIP_SIZE                  0x20000000U
+/** @} */
+
+/**
+ * @name    SPI NOR commands
+ * @{
+ */
+#define XIP_CMD_WRITE_ENABLE            0x06
+#define XIP_CMD_READ_STATUS             0x05
+#define XIP_CMD_WRITE_STATUS            0x01
+#define XIP_CMD_READ                    0x03
+#define XIP_CMD_QUAD_IO_READ            0xEB
+#define XIP_CMD_PAGE_PROGRAM            0x02
+#define XIP_CMD_SECTOR_ERASE            0x20
+#define XIP_CMD_BLOCK_ERASE             0xD8
+#define XIP_CMD_SUSPEND                 0x75
+#define XIP_CMD_RESUME                  0x7A
+/** @} */
+
+/**
+ * @name    SPI NOR status register definitions
+ * @{
+ */
+#define XIP_STATUS_WIP                  (1U << 0)
+#define XIP_STATUS_WEL                  (1U << 1)
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   XIP tuning enable switch.
+ * @details If set to @p TRUE @p hal_lld_init() calls @p fe310XipInit().
+ */
+#if !defined(FE310_USE_XIP) || defined(__DOXYGEN__)
+#define FE310_USE_XIP                       FALSE
+#endif
+
+/**
+ * @brief   Section of the reconfiguration code.
+ * @details No flash fetch is possible while QSPI0 is out of the memory
+ *          mapped mode. The default places the code in the ITIM, use
+ *          @p ".ramtext" to run it from the DTIM where the ITIM is not
+ *          mapped.
+ */
+#if !defined(FE310_XIP_SECTION) || defined(__DOXYGEN__)
+#define FE310_XIP_SECTION                   ".ram1_init.fe310_xip"
+#endif
+
+/**
+ * @brief   Maximum SCK frequency of the memory mapped reads.
+ * @details The divisor is the smallest one not exceeding this frequency
+ *          with the configured @p FE310_CORECLK.
+ */
+#if !defined(FE310_XIP_SCK_MAX) || defined(__DOXYGEN__)
+#define FE310_XIP_SCK_MAX                   50000000
+#endif
+
+/**
+ * @brief   Dummy cycles of the quad I/O read, mode byte included.
+ * @details Six is the power-up setting of the ISSI IS25LP parts fitted on
+ *          the RED-V and HiFive1 Rev B boards, it covers their whole
+ *          quad I/O frequency range.
+ */
+#if !defined(FE310_XIP_DUMMY_CYCLES) || defined(__DOXYGEN__)
+#define FE310_XIP_DUMMY_CYCLES              6
+#endif
+
+/**
+ * @brief   Quad enable bit of the status register.
+ * @details Bit 6 on ISSI and Macronix parts. The bit is non volatile and
+ *          only written when found clear.
+ */
+#if !defined(FE310_XIP_QE_MASK) || defined(__DOXYGEN__)
+#define FE310_XIP_QE_MASK                   (1U << 6)
+#endif
+
+/**
+ * @brief   Status register write timeout, in milliseconds.
+ */
+#if !defined(FE310_XIP_WRITE_TIMEOUT) || defined(__DOXYGEN__)
+#define FE310_XIP_WRITE_TIMEOUT             100
+#endif
+
+/**
+ * @brief   Size of the read back test, in bytes.
+ * @details The test window starts at the flash base and is read before
+ *          and after the switch.
+ */
+#if !defined(FE310_XIP_TEST_SIZE) || defined(__DOXYGEN__)
+#define FE310_XIP_TEST_SIZE                 1024
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   SCKDIV value of the memory mapped reads.
+ */
+#define FE310_XIP_SCKDIV                    SPI_SCKDIV_FOR(FE310_CORECLK,   \
+                                                           FE310_XIP_SCK_MAX)
+
+/**
+ * @brief   Resulting SCK frequency.
+ */
+#define FE310_XIP_SCK                       SPI_SCKDIV_HZ(FE310_CORECLK,    \
+                                                          FE310_XIP_SCKDIV)
+
+/**
+ * @brief   Status register write timeout, in core cycles.
+ */
+#define FE310_XIP_WRITE_CYCLES                                              \
+  ((FE310_CORECLK / 1000U) * FE310_XIP_WRITE_TIMEOUT)
+
+#if FE310_USE_XIP == TRUE
+#if FE310_XIP_SCKDIV > SPI_SCKDIV_DIV_MASK
+#error "FE310_XIP_SCK_MAX cannot be obtained from FE310_CORECLK"
+#endif
+
+#if (FE310_XIP_DUMMY_CYCLES < 2) ||                                         \
+    (FE310_XIP_DUMMY_CYCLES > SPI_FFMT_PAD_CNT_MASK)
+#error "FE310_XIP_DUMMY_CYCLES out of range"
+#endif
+
+#if (FE310_XIP_TEST_SIZE < 4) || ((FE310_XIP_TEST_SIZE % 4) != 0)
+#error "FE310_XIP_TEST_SIZE must be a non zero multiple of 4"
+#endif
+
+#if FE310_XIP_WRITE_CYCLES > 0x7FFFFFFFU
+#error "FE310_XIP_WRITE_TIMEOUT too large for FE310_CORECLK"
+#endif
+#endif
+
+/**
+ * @brief   FFMT value of the quad I/O read.
+ * @details Single lane command, 24 bits address and data on four lanes.
+ *          The mode byte is sent as zero in the first dummy cycles so the
+ *          flash never enters the continuous read mode and keeps
+ *          accepting commands.
+ */
+#define FE310_XIP_FFMT_QUAD                                                 \
+  (SPI_FFMT_CMD_EN | SPI_FFMT_ADDR_LEN(3) |                                 \
+   SPI_FFMT_PAD_CNT(FE310_XIP_DUMMY_CYCLES) |                               \
+   SPI_FFMT_CMD_PROTO(SPI_FMT_PROTO_SINGLE) |                               \
+   SPI_FFMT_ADDR_PROTO(SPI_FMT_PROTO_QUAD) |                                \
+   SPI_FFMT_DATA_PROTO(SPI_FMT_PROTO_QUAD) |                                \
+   SPI_FFMT_CMD_CODE(XIP_CMD_QUAD_IO_READ) | SPI_FFMT_PAD_CODE(0x00))
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Tells whether the memory mapped reads use four data lanes.
+ *
+ * @return              The read mode.
+ * @retval false        single lane reads.
+ * @retval true         quad I/O reads.
+ *
+ * @xclass
+ */
+#define fe310XipIsQuadX()                                                   \
+  ((QSPI0->FFMT & SPI_FFMT_DATA_PROTO(SPI_FMT_PROTO_MASK)) ==               \
+   SPI_FFMT_DATA_PROTO(SPI_FMT_PROTO_QUAD))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (FE310_USE_XIP == TRUE) || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  bool fe310XipInit(void);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+#endif /* FE310_XIP_H */
+
+/** @} */
@@ -0,0 +1,695 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_efl_lld.c
+ * @brief   FE310 Embedded Flash subsystem low level driver source.
+ *
+ * @addtogroup HAL_EFL
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if (HAL_USE_EFL == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Program and erase code attributes.
+ */
+#define EFL_RAM_CODE    __attribute__((noinline, section(FE310_EFL_SECTION)))
+
+/**
+ * @brief   Helpers inlined in the program and erase code.
+ */
+#define EFL_INLINE      static inline __attribute__((always_inline))
+
+/**
+ * @brief   FMT value of the programmed I/O commands.
+ */
+#define EFL_FMT_COMMAND (SPI_FMT_PROTO_SINGLE | SPI_FMT_ENDIAN_MSB |        \
+                         SPI_FMT_DIR_RX | SPI_FMT_LEN(8))
+
+/**
+ * @brief   Erase suspend attribute.
+ */
+#if (FE310_EFL_USE_SUSPEND == TRUE) || defined(__DOXYGEN__)
+#define EFL_ATTR_SUSPEND                    FLASH_ATTR_SUSPEND_ERASE_CAPABLE
+#else
+#define EFL_ATTR_SUSPEND                    0U
+#endif
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   EFL1 driver identifier.
+ */
+EFlashDriver EFLD1;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Flash area descriptor.
+ */
+static const flash_descriptor_t efl_lld_descriptor = {
+  .attributes       = FLASH_ATTR_ERASED_IS_ONE |
+                      FLASH_ATTR_MEMORY_MAPPED |
+                      EFL_ATTR_SUSPEND,
+  .page_size        = FE310_EFL_PAGE_SIZE,
+  .sectors_count    = FE310_EFL_SIZE / FE310_EFL_SECTOR_SIZE,
+  .sectors          = NULL,
+  .sectors_size     = FE310_EFL_SECTOR_SIZE,
+  .address          = (uint8_t *)(FE310_XIP_BASE + FE310_EFL_BASE),
+  .size             = FE310_EFL_SIZE
+};
+
+/**
+ * @brief   Page buffer for sources located in the flash.
+ */
+static uint8_t efl_page[FE310_EFL_PAGE_SIZE];
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Exchanges a byte with the flash.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] b         byte to be sent
+ * @return              The byte received.
+ */
+EFL_INLINE uint32_t efl_xfer(fe310_spi_t *qspi, uint32_t b) {
+  uint32_t rx;
+
+  qspi->TXDATA = b;
+  do {
+    rx = qspi->RXDATA;
+  } while ((rx & SPI_RXDATA_EMPTY) != 0U);
+
+  return rx & SPI_RXDATA_DATA_MASK;
+}
+
+/**
+ * @brief   Sends a header and a data block in a single selection.
+ * @details The TX FIFO is kept loaded so SCK runs without gaps, the
+ *          frames in flight never exceed the RX FIFO size.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] hdr       command and address bytes
+ * @param[in] hn        number of header bytes
+ * @param[in] data      data bytes, in RAM
+ * @param[in] dn        number of data bytes
+ */
+EFL_INLINE void efl_send(fe310_spi_t *qspi, const uint8_t *hdr, size_t hn,
+                         const uint8_t *data, size_t dn) {
+  size_t total = hn + dn, tx = 0U, rx = 0U;
+
+  qspi->CSMODE = SPI_CSMODE_HOLD;
+  while (rx < total) {
+    if ((tx < total) && ((tx - rx) < SPI_FIFO_SIZE)) {
+      qspi->TXDATA = tx < hn ? hdr[tx] : data[tx - hn];
+      tx++;
+    }
+    if ((qspi->RXDATA & SPI_RXDATA_EMPTY) == 0U) {
+      rx++;
+    }
+  }
+  qspi->CSMODE = SPI_CSMODE_AUTO;
+}
+
+/**
+ * @brief   Sends a command without address nor data.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] cmd       command code
+ */
+EFL_INLINE void efl_command(fe310_spi_t *qspi, uint32_t cmd) {
+
+  qspi->CSMODE = SPI_CSMODE_HOLD;
+  (void) efl_xfer(qspi, cmd);
+  qspi->CSMODE = SPI_CSMODE_AUTO;
+}
+
+/**
+ * @brief   Sends a command with a 24 bits address.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] cmd       command code
+ * @param[in] addr      flash address
+ * @param[in] data      data bytes, in RAM
+ * @param[in] dn        number of data bytes
+ */
+EFL_INLINE void efl_command_addr(fe310_spi_t *qspi, uint32_t cmd,
+                                 uint32_t addr, const uint8_t *data,
+                                 size_t dn) {
+  uint8_t hdr[4];
+
+  hdr[0] = (uint8_t)cmd;
+  hdr[1] = (uint8_t)(addr >> 16);
+  hdr[2] = (uint8_t)(addr >> 8);
+  hdr[3] = (uint8_t)addr;
+  efl_send(qspi, hdr, 4U, data, dn);
+}
+
+/**
+ * @brief   Waits for the end of a program or erase.
+ * @details The status register is clocked out continuously in a single
+ *          selection instead of being polled with a command per read.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ */
+EFL_INLINE void efl_wait_ready(fe310_spi_t *qspi) {
+
+  qspi->CSMODE = SPI_CSMODE_HOLD;
+  (void) efl_xfer(qspi, XIP_CMD_READ_STATUS);
+  while ((efl_xfer(qspi, 0xFF) & XIP_STATUS_WIP) != 0U) {
+  }
+  qspi->CSMODE = SPI_CSMODE_AUTO;
+}
+
+/**
+ * @brief   Disables the memory mapped mode.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ */
+EFL_INLINE void efl_leave_xip(fe310_spi_t *qspi) {
+
+  qspi->FCTRL = 0U;
+  qspi->FMT   = EFL_FMT_COMMAND;
+  while ((qspi->RXDATA & SPI_RXDATA_EMPTY) == 0U) {
+  }
+}
+
+/**
+ * @brief   Enables the memory mapped mode.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] fmt       FMT value to be restored
+ * @param[in] csmode    CSMODE value to be restored
+ */
+EFL_INLINE void efl_enter_xip(fe310_spi_t *qspi,
+                              uint32_t fmt, uint32_t csmode) {
+
+  qspi->FMT    = fmt;
+  qspi->CSMODE = csmode;
+  qspi->FCTRL  = SPI_FCTRL_EN;
+}
+
+/**
+ * @brief   Tells whether an enabled interrupt is pending.
+ *
+ * @return              The pending status.
+ */
+EFL_INLINE bool efl_irq_pending(void) {
+  uint32_t ip, ie;
+
+  RISCV_CSR_READ(ip, mip);
+  RISCV_CSR_READ(ie, mie);
+
+  return (ip & ie) != 0U;
+}
+
+/**
+ * @brief   Serves the pending interrupts from the flash.
+ * @details The flash must be idle or suspended, interrupts are unmasked
+ *          for a single instruction and only if they were enabled by the
+ *          caller. A preemption may happen there.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] fmt       FMT value to be restored
+ * @param[in] csmode    CSMODE value to be restored
+ * @param[in] sts       caller @p mstatus
+ */
+EFL_INLINE void efl_yield(fe310_spi_t *qspi, uint32_t fmt, uint32_t csmode,
+                          uint32_t sts) {
+
+  efl_enter_xip(qspi, fmt, csmode);
+  RISCV_CSR_SET(mstatus, sts & 8U);
+  RISCV_CSR_CLEAR_I(mstatus, 8);
+  efl_leave_xip(qspi);
+}
+
+/**
+ * @brief   Programs a range.
+ * @details Pages are issued back to back without leaving the programmed
+ *          I/O mode, the next page is sent as soon as the status reports
+ *          the end of the previous one. Pending interrupts are only
+ *          served between two pages.
+ * @note    Runs with interrupts masked, it must not call any code outside
+ *          its section nor read constants from the flash.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] addr      flash address
+ * @param[in] pp        data to be programmed, in RAM
+ * @param[in] n         number of bytes, greater than zero
+ */
+static void EFL_RAM_CODE efl_program_run(fe310_spi_t *qspi, uint32_t addr,
+                                         const uint8_t *pp, size_t n) {
+  uint32_t fmt = qspi->FMT, csmode = qspi->CSMODE, sts;
+  size_t chunk;
+
+  RISCV_CSR_READ_CLEAR_I(sts, mstatus, 8);
+  efl_leave_xip(qspi);
+
+  while (true) {
+    chunk = FE310_EFL_PAGE_SIZE - (addr & (FE310_EFL_PAGE_SIZE - 1U));
+    if (chunk > n) {
+      chunk = n;
+    }
+
+    efl_command(qspi, XIP_CMD_WRITE_ENABLE);
+    efl_command_addr(qspi, XIP_CMD_PAGE_PROGRAM, addr, pp, chunk);
+    addr += chunk;
+    pp   += chunk;
+    n    -= chunk;
+    efl_wait_ready(qspi);
+
+    if (n == 0U) {
+      break;
+    }
+    if (((sts & 8U) != 0U) && efl_irq_pending()) {
+      efl_yield(qspi, fmt, csmode, sts);
+    }
+  }
+
+  efl_enter_xip(qspi, fmt, csmode);
+  RISCV_CSR_SET(mstatus, sts & 8U);
+}
+
+/**
+ * @brief   Erases a sector or a block.
+ * @details With @p FE310_EFL_USE_SUSPEND the erase is suspended when an
+ *          enabled interrupt is pending, at most once per
+ *          @p FE310_EFL_ERASE_SLICE.
+ * @note    Runs with interrupts masked, it must not call any code outside
+ *          its section nor read constants from the flash.
+ *
+ * @param[in] qspi      pointer to the QSPI registers block
+ * @param[in] cmd       erase command code
+ * @param[in] addr      flash address
+ */
+static void EFL_RAM_CODE efl_erase_run(fe310_spi_t *qspi, uint32_t cmd,
+                                       uint32_t addr) {
+  uint32_t fmt = qspi->FMT, csmode = qspi->CSMODE, sts;
+#if FE310_EFL_USE_SUSPEND == TRUE
+  uint32_t start, now;
+#endif
+
+  RISCV_CSR_READ_CLEAR_I(sts, mstatus, 8);
+  efl_leave_xip(qspi);
+
+  efl_command(qspi, XIP_CMD_WRITE_ENABLE);
+  efl_command_addr(qspi, cmd, addr, NULL, 0U);
+
+#if FE310_EFL_USE_SUSPEND == TRUE
+  RISCV_CSR_READ(start, mcycle);
+  qspi->CSMODE = SPI_CSMODE_HOLD;
+  (void) efl_xfer(qspi, XIP_CMD_READ_STATUS);
+  while ((efl_xfer(qspi, 0xFF) & XIP_STATUS_WIP) != 0U) {
+    RISCV_CSR_READ(now, mcycle);
+    if (((sts & 8U) != 0U) &&
+        ((now - start) >= (uint32_t)FE310_EFL_SLICE_CYCLES) &&
+        efl_irq_pending()) {
+      qspi->CSMODE = SPI_CSMODE_AUTO;
+
+      /* The status reports idle once the erase is suspended.*/
+      efl_command(qspi, XIP_CMD_SUSPEND);
+      efl_wait_ready(qspi);
+      efl_yield(qspi, fmt, csmode, sts);
+      efl_command(qspi, XIP_CMD_RESUME);
+
+      RISCV_CSR_READ(start, mcycle);
+      qspi->CSMODE = SPI_CSMODE_HOLD;
+      (void) efl_xfer(qspi, XIP_CMD_READ_STATUS);
+    }
+  }
+  qspi->CSMODE = SPI_CSMODE_AUTO;
+#else
+  efl_wait_ready(qspi);
+#endif
+
+  efl_enter_xip(qspi, fmt, csmode);
+  RISCV_CSR_SET(mstatus, sts & 8U);
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level Embedded Flash driver initialization.
+ *
+ * @notapi
+ */
+void efl_lld_init(void) {
+
+  /* Driver initialization.*/
+  eflObjectInit(&EFLD1);
+  EFLD1.qspi = QSPI0;
+}
+
+/**
+ * @brief   Configures and activates the Embedded Flash peripheral.
+ * @details QSPI0 is owned by the memory mapped mode, nothing to do.
+ *
+ * @param[in] eflp      pointer to a @p EFlashDriver structure
+ *
+ * @notapi
+ */
+void efl_lld_start(EFlashDriver *eflp) {
+
+  (void)eflp;
+}
+
+/**
+ * @brief   Deactivates the Embedded Flash peripheral.
+ *
+ * @param[in] eflp      pointer to a @p EFlashDriver structure
+ *
+ * @notapi
+ */
+void efl_lld_stop(EFlashDriver *eflp) {
+
+  (void)eflp;
+}
+
+/**
+ * @brief   Gets the flash descriptor structure.
+ *
+ * @param[in] instance  pointer to a @p EFlashDriver instance
+ * @return              A flash device descriptor.
+ *
+ * @notapi
+ */
+const flash_descriptor_t *efl_lld_get_descriptor(void *instance) {
+
+  (void)instance;
+
+  return &efl_lld_descriptor;
+}
+
+/**
+ * @brief   Read operation.
+ *
+ * @param[in] instance  pointer to a @p EFlashDriver instance
+ * @param[in] offset    flash offset
+ * @param[in] n         number of bytes to be read
+ * @param[out] rp       pointer to the data buffer
+ * @return              An error code.
+ * @retval FLASH_NO_ERROR           if there is no erase operation in progress.
+ * @retval FLASH_BUSY_ERASING       if there is an erase operation in progress.
+ *
+ * @notapi
+ */
+flash_error_t efl_lld_read(void *instance, flash_offset_t offset,
+                           size_t n, uint8_t *rp) {
+  EFlashDriver *devp = (EFlashDriver *)instance;
+
+  osalDbgCheck((instance != NULL) && (rp != NULL) && (n > 0U));
+  osalDbgCheck((size_t)offset + n <= (size_t)efl_lld_descriptor.size);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  /* No reading while erasing.*/
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  /* FLASH_READ state while the operation is performed.*/
+  devp->state = FLASH_READ;
+
+  /* Reads go through the memory map.*/
+  memcpy((void *)rp, (const void *)(efl_lld_descriptor.address + offset), n);
+
+  /* Ready state again.*/
+  devp->state = FLASH_READY;
+
+  return FLASH_NO_ERROR;
+}
+
+/**
+ * @brief   Program operation.
+ * @details Sources in RAM are programmed in a single run, sources located
+ *          in the flash itself are staged one page at a time.
+ *
+ * @param[in] instance  pointer to a @p EFlashDriver instance
+ * @param[in] offset    flash offset
+ * @param[in] n         number of bytes to be programmed
+ * @param[in] pp        pointer to the data buffer
+ * @return              An error code.
+ * @retval FLASH_NO_ERROR           if there is no erase operation in progress.
+ * @retval FLASH_BUSY_ERASING       if there is an erase operation in progress.
+ * @retval FLASH_ERROR_PROGRAM      if the data read back does not match,
+ *                                  the area was not erased or is protected.
+ *
+ * @notapi
+ */
+flash_error_t efl_lld_program(void *instance, flash_offset_t offset,
+                              size_t n, const uint8_t *pp) {
+  EFlashDriver *devp = (EFlashDriver *)instance;
+  flash_error_t err = FLASH_NO_ERROR;
+  const uint8_t *p;
+  uint32_t addr;
+  size_t chunk, left;
+
+  osalDbgCheck((instance != NULL) && (pp != NULL) && (n > 0U));
+  osalDbgCheck((size_t)offset + n <= (size_t)efl_lld_descriptor.size);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  /* No programming while erasing.*/
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  /* FLASH_PGM state while the operation is performed.*/
+  devp->state = FLASH_PGM;
+
+  addr = FE310_EFL_BASE + offset;
+  if (((uint32_t)pp < FE310_XIP_BASE + FE310_XIP_SIZE) &&
+      ((uint32_t)pp + n > FE310_XIP_BASE)) {
+    /* The source cannot be read while the memory map is disabled.*/
+    p    = pp;
+    left = n;
+    while (left > 0U) {
+      chunk = FE310_EFL_PAGE_SIZE - (addr & (FE310_EFL_PAGE_SIZE - 1U));
+      if (chunk > left) {
+        chunk = left;
+      }
+      memcpy(efl_page, p, chunk);
+      efl_program_run(devp->qspi, addr, efl_page, chunk);
+      addr += chunk;
+      p    += chunk;
+      left -= chunk;
+    }
+  }
+  else {
+    efl_program_run(devp->qspi, addr, pp, n);
+  }
+
+  /* Bits can only be cleared, a mismatch means a non erased or protected
+     area.*/
+  if (memcmp((const void *)(efl_lld_descriptor.address + offset),
+             (const void *)pp, n) != 0) {
+    err = FLASH_ERROR_PROGRAM;
+  }
+
+  /* Ready state again.*/
+  devp->state = FLASH_READY;
+
+  return err;
+}
+
+/**
+ * @brief   Starts a whole-device erase operation.
+ * @details Erases the whole driver area, using block erases where the
+ *          alignment allows it.
+ * @note    The erase is complete on return, the code runs from the flash
+ *          only while the erase is suspended.
+ *
+ * @param[in] instance  pointer to a @p EFlashDriver instance
+ * @return              An error code.
+ * @retval FLASH_NO_ERROR           if there is no erase operation in progress.
+ * @retval FLASH_BUSY_ERASING       if there is an erase operation in progress.
+ *
+ * @notapi
+ */
+flash_error_t efl_lld_start_erase_all(void *instance) {
+  EFlashDriver *devp = (EFlashDriver *)instance;
+  uint32_t addr, end;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  /* No erasing while erasing.*/
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  /* FLASH_ERASE state until the query.*/
+  devp->state = FLASH_ERASE;
+
+  addr = FE310_EFL_BASE;
+  end  = FE310_EFL_BASE + FE310_EFL_SIZE;
+  while (addr < end) {
+    if (((addr & (FE310_EFL_BLOCK_SIZE - 1U)) == 0U) &&
+        ((end - addr) >= FE310_EFL_BLOCK_SIZE)) {
+      efl_erase_run(devp->qspi, XIP_CMD_BLOCK_ERASE, addr);
+      addr += FE310_EFL_BLOCK_SIZE;
+    }
+    else {
+      efl_erase_run(devp->qspi, XIP_CMD_SECTOR_ERASE, addr);
+      addr += FE310_EFL_SECTOR_SIZE;
+    }
+  }
+
+  return FLASH_NO_ERROR;
+}
+
+/**
+ * @brief   Starts an sector erase operation.
+ * @note    The erase is complete on return, the code runs from the flash
+ *          only while the erase is suspended.
+ *
+ * @param[in] instance  pointer to a @p EFlashDriver instance
+ * @param[in] sector    sector to be erased
+ * @return              An error code.
+ * @retval FLASH_NO_ERROR           if there is no erase operation in progress.
+ * @retval FLASH_BUSY_ERASING       if there is an erase operation in progress.
+ *
+ * @notapi
+ */
+flash_error_t efl_lld_start_erase_sector(void *instance,
+                                         flash_sector_t sector) {
+  EFlashDriver *devp = (EFlashDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgCheck(sector < efl_lld_descriptor.sectors_count);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  /* No erasing while erasing.*/
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  /* FLASH_ERASE state until the query.*/
+  devp->state = FLASH_ERASE;
+
+  efl_erase_run(devp->qspi, XIP_CMD_SECTOR_ERASE,
+                FE310_EFL_BASE + (sector * FE310_EFL_SECTOR_SIZE));
+
+  return FLASH_NO_ERROR;
+}
+
+/**
+ * @brief   Queries the driver for erase operation progress.
+ * @details The erase functions return on completion, the state is
+ *          returned to ready.
+ *
+ * @param[in] instance  pointer to a @p EFlashDriver instance
+ * @param[out] msec     recommended time, in milliseconds, that
+ *                      should be spent before calling this
+ *                      function again, can be @p NULL
+ * @return              An error code.
+ * @retval FLASH_NO_ERROR           if there is no erase operation in progress.
+ *
+ * @notapi
+ */
+flash_error_t efl_lld_query_erase(void *instance, uint32_t *msec) {
+  EFlashDriver *devp = (EFlashDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  (void)msec;
+
+  /* If there is an erase in progress then the device must be checked.*/
+  if (devp->state == FLASH_ERASE) {
+    devp->state = FLASH_READY;
+  }
+
+  return FLASH_NO_ERROR;
+}
+
+/**
+ * @brief   Returns the erase state of a sector.
+ *
+ * @param[in] instance  pointer to a @p EFlashDriver instance
+ * @param[in] sector    sector to be verified
+ * @return              An error code.
+ * @retval FLASH_NO_ERROR           if the sector is erased.
+ * @retval FLASH_BUSY_ERASING       if there is an erase operation in progress.
+ * @retval FLASH_ERROR_VERIFY       if the verify operation failed.
+ *
+ * @notapi
+ */
+flash_error_t efl_lld_verify_erase(void *instance, flash_sector_t sector) {
+  EFlashDriver *devp = (EFlashDriver *)instance;
+  const volatile uint32_t *address;
+  flash_error_t err = FLASH_NO_ERROR;
+  unsigned i;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgCheck(sector < efl_lld_descriptor.sectors_count);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  /* No verifying while erasing.*/
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  /* Address of the sector.*/
+  address = (const volatile uint32_t *)(efl_lld_descriptor.address +
+                                        (sector * FE310_EFL_SECTOR_SIZE));
+
+  /* FLASH_READ state while the operation is performed.*/
+  devp->state = FLASH_READ;
+
+  /* Scanning the sector space.*/
+  for (i = 0U; i < FE310_EFL_SECTOR_SIZE / sizeof(uint32_t); i++) {
+    if (address[i] != 0xFFFFFFFFU) {
+      err = FLASH_ERROR_VERIFY;
+      break;
+    }
+  }
+
+  /* Ready state again.*/
+  devp->state = FLASH_READY;
+
+  return err;
+}
+
+#endif /* HAL_USE_EFL == TRUE */
+
+/** @} */
@@ -0,0 +1,178 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_efl_lld.h
+ * @brief   FE310 Embedded Flash subsystem low level driver header.
+ * @details The driver exposes an area of the SPI NOR behind QSPI0, the
+ *          same flash the code is executed from. Program and erase
+ *          commands are sent from @p FE310_EFL_SECTION with the memory
+ *          mapped mode disabled, reads go through the memory map.
+ *
+ * @addtogroup HAL_EFL
+ * @{
+ */
+
+#ifndef HAL_EFL_LLD_H
+#define HAL_EFL_LLD_H
+
+#include "fe310_xip.h"
+
+#if (HAL_USE_EFL == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    SPI NOR geometry
+ * @{
+ */
+#define FE310_EFL_PAGE_SIZE                 256U
+#define FE310_EFL_SECTOR_SIZE               4096U
+#define FE310_EFL_BLOCK_SIZE                65536U
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    FE310 configuration options
+ * @{
+ */
+/**
+ * @brief   Offset of the driver area in the flash.
+ * @details The default is the last megabyte of the 4MB parts, the linked
+ *          image must end below it.
+ */
+#if !defined(FE310_EFL_BASE) || defined(__DOXYGEN__)
+#define FE310_EFL_BASE                      0x00300000U
+#endif
+
+/**
+ * @brief   Size of the driver area.
+ */
+#if !defined(FE310_EFL_SIZE) || defined(__DOXYGEN__)
+#define FE310_EFL_SIZE                      0x00100000U
+#endif
+
+/**
+ * @brief   Section of the program and erase code.
+ * @details No flash fetch is possible while a command is in progress.
+ *          Code that must keep running during an erase, interrupt
+ *          handlers included, must be placed in RAM too.
+ */
+#if !defined(FE310_EFL_SECTION) || defined(__DOXYGEN__)
+#define FE310_EFL_SECTION                   ".ramtext"
+#endif
+
+/**
+ * @brief   Erase suspend switch.
+ * @details If set to @p TRUE a running erase is suspended when an enabled
+ *          interrupt becomes pending, the interrupt is served from the
+ *          flash and the erase is resumed. If @p FALSE interrupts stay
+ *          masked until the erase is complete.
+ * @note    The erased sector or block reads as garbage while suspended.
+ */
+#if !defined(FE310_EFL_USE_SUSPEND) || defined(__DOXYGEN__)
+#define FE310_EFL_USE_SUSPEND               TRUE
+#endif
+
+/**
+ * @brief   Minimum erase time between two suspends, in microseconds.
+ * @details Guarantees the erase progress under a high interrupt rate.
+ */
+#if !defined(FE310_EFL_ERASE_SLICE) || defined(__DOXYGEN__)
+#define FE310_EFL_ERASE_SLICE               500
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if ((FE310_EFL_BASE % FE310_EFL_SECTOR_SIZE) != 0) ||                      \
+    ((FE310_EFL_SIZE % FE310_EFL_SECTOR_SIZE) != 0) ||                      \
+    (FE310_EFL_SIZE == 0)
+#error "FE310_EFL_BASE and FE310_EFL_SIZE must be multiples of the sector size"
+#endif
+
+#if FE310_EFL_BASE + FE310_EFL_SIZE > 0x01000000U
+#error "FE310_EFL area beyond the 24 bits address range"
+#endif
+
+/**
+ * @brief   Minimum erase time between two suspends, in core cycles.
+ */
+#define FE310_EFL_SLICE_CYCLES                                              \
+  ((FE310_CORECLK / 1000000U) * FE310_EFL_ERASE_SLICE)
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level fields of the embedded flash driver structure.
+ */
+#define efl_lld_driver_fields                                               \
+  /* Pointer to the QSPI registers block.*/                                 \
+  fe310_spi_t               *qspi
+
+/**
+ * @brief   Low level fields of the embedded flash configuration structure.
+ */
+#define efl_lld_config_fields                                               \
+  /* Dummy configuration, it is not needed.*/                               \
+  uint32_t                  dummy
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if !defined(__DOXYGEN__)
+extern EFlashDriver EFLD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void efl_lld_init(void);
+  void efl_lld_start(EFlashDriver *eflp);
+  void efl_lld_stop(EFlashDriver *eflp);
+  const flash_descriptor_t *efl_lld_get_descriptor(void *instance);
+  flash_error_t efl_lld_read(void *instance, flash_offset_t offset,
+                             size_t n, uint8_t *rp);
+  flash_error_t efl_lld_program(void *instance, flash_offset_t offset,
+                                size_t n, const uint8_t *pp);
+  flash_error_t efl_lld_start_erase_all(void *instance);
+  flash_error_t efl_lld_start_erase_sector(void *instance,
+                                           flash_sector_t sector);
+  flash_error_t efl_lld_query_erase(void *instance, uint32_t *msec);
+  flash_error_t efl_lld_verify_erase(void *instance, flash_sector_t sector);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_EFL == TRUE */
+
+#endif /* HAL_EFL_LLD_H */
+
+/** @} */
@@ -57,6 +57,11 @@ void hal_lld_init(void) {
 
   /* IRQ subsystem initialization.*/
   plicInit ();
+
+#if FE310_USE_XIP == TRUE
+  /* Faster flash reads, the RAM areas are initialized at this point.*/
+  (void) fe310XipInit();
+#endif
 }
 
 /**
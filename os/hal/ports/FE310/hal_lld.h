@@ -460,6 +460,8 @@
 #include "plic.h"
 #include "fe310_isr.h"
 #include "fe310_prci.h"
+#include "fe310_pcon.h"
+#include "fe310_xip.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,10 +30,24 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Pad interrupts are used by PAL events or by the inputs service.
+ */
+#define PAL_USE_PAD_IRQS ((PAL_USE_WAIT == TRUE) ||                         \
+                          (PAL_USE_CALLBACKS == TRUE) ||                    \
+                          (FE310_USE_INPUT == TRUE))
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
 
+#if (PAL_USE_WAIT == TRUE) || (PAL_USE_CALLBACKS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Event records for the 32 GPIO pads.
+ */
+palevent_t _pal_events[PAL_IOPORTS_WIDTH];
+#endif
+
 /*===========================================================================*/
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
@@ -42,27 +56,123 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if PAL_USE_PAD_IRQS || defined(__DOXYGEN__)
+/**
+ * @brief   Common pad interrupt code.
+ * @details Only the latched edges are cleared before the dispatch, an edge
+ *          happening after the read or during the callback raises the
+ *          interrupt again.
+ *
+ * @param[in] pad       the pad number
+ */
+static inline void serve_pad_interrupt(uint32_t pad) {
+  uint32_t m = 1U << pad;
+  uint32_t rise = GPIO0->RISE_IP & m;
+  uint32_t fall = GPIO0->FALL_IP & m;
+
+  /* Write one to clear.*/
+  GPIO0->RISE_IP = rise;
+  GPIO0->FALL_IP = fall;
+
+#if FE310_USE_INPUT == TRUE
+  _fe310_input_serve(pad, (rise != 0U ? 1U : 0U) + (fall != 0U ? 1U : 0U));
+#endif
+#if (PAL_USE_WAIT == TRUE) || (PAL_USE_CALLBACKS == TRUE)
+  _pal_isr_code(pad);
+#endif
+}
+#endif
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
 
+#if PAL_USE_PAD_IRQS || defined(__DOXYGEN__)
+/**
+ * @brief   GPIO pad interrupt handler.
+ *
+ * @param[in] irq       PLIC source number
+ * @param[in] pad       pad number
+ */
+#define PAL_PAD_HANDLER(irq, pad)                                           \
+OSAL_IRQ_HANDLER(PlicInterrupt##irq) {                                      \
+                                                                            \
+  OSAL_IRQ_PROLOGUE();                                                      \
+                                                                            \
+  serve_pad_interrupt(pad);                                                 \
+                                                                            \
+  OSAL_IRQ_EPILOGUE();                                                      \
+}
+
+#if FE310_GPIO0_FIRST_NUMBER != 8
+#error "GPIO handlers assume FE310_GPIO0_FIRST_NUMBER is 8"
+#endif
+
+PAL_PAD_HANDLER(8,  0)
+PAL_PAD_HANDLER(9,  1)
+PAL_PAD_HANDLER(10, 2)
+PAL_PAD_HANDLER(11, 3)
+PAL_PAD_HANDLER(12, 4)
+PAL_PAD_HANDLER(13, 5)
+PAL_PAD_HANDLER(14, 6)
+PAL_PAD_HANDLER(15, 7)
+PAL_PAD_HANDLER(16, 8)
+PAL_PAD_HANDLER(17, 9)
+PAL_PAD_HANDLER(18, 10)
+PAL_PAD_HANDLER(19, 11)
+PAL_PAD_HANDLER(20, 12)
+PAL_PAD_HANDLER(21, 13)
+PAL_PAD_HANDLER(22, 14)
+PAL_PAD_HANDLER(23, 15)
+PAL_PAD_HANDLER(24, 16)
+PAL_PAD_HANDLER(25, 17)
+PAL_PAD_HANDLER(26, 18)
+PAL_PAD_HANDLER(27, 19)
+PAL_PAD_HANDLER(28, 20)
+PAL_PAD_HANDLER(29, 21)
+PAL_PAD_HANDLER(30, 22)
+PAL_PAD_HANDLER(31, 23)
+PAL_PAD_HANDLER(32, 24)
+PAL_PAD_HANDLER(33, 25)
+PAL_PAD_HANDLER(34, 26)
+PAL_PAD_HANDLER(35, 27)
+PAL_PAD_HANDLER(36, 28)
+PAL_PAD_HANDLER(37, 29)
+PAL_PAD_HANDLER(38, 30)
+PAL_PAD_HANDLER(39, 31)
+#endif
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
 
 /**
- * @brief   STM32 I/O ports configuration.
+ * @brief   FE310 I/O ports configuration.
+ * @details Applies @p pal_default_config if enabled.
  *
  * @notapi
  */
 void _pal_lld_init(void) {
 
+#if (PAL_USE_WAIT == TRUE) || (PAL_USE_CALLBACKS == TRUE)
+  unsigned i;
+
+  for (i = 0; i < PAL_IOPORTS_WIDTH; i++) {
+    _pal_init_event(i);
+  }
+#endif
+
+#if FE310_PAL_USE_DEFAULT_CONFIG == TRUE
+  fe310PalApply(GPIO0, &pal_default_config.GPIO0Data);
+#endif
 }
 
 /**
  * @brief   Pads mode setup.
  * @details This function programs a pads group belonging to the same port
  *          with the specified mode.
+ * @note    Each register is updated for the whole group with a single
+ *          atomic operation.
  *
  * @param[in] port      the port identifier
  * @param[in] mask      the group mask
@@ -78,54 +188,251 @@ void _pal_lld_setgroupmode(ioportid_t port,
   uint32_t ospeedr = (mode & PAL_FE310_OSPEED_MASK) >> 3;
   uint32_t pupdr   = (mode & PAL_FE310_PUPDR_MASK) >> 5;
   uint32_t altr    = (mode & PAL_FE310_ALTERNATE_MASK) >> 7;
-  uint32_t bit     = 0;
-  while (true) {
-    if ((mask & 1) != 0) {
-      uint32_t m1 = 1 << bit;
-
-      if (pupdr)
-        port->PULLUP_EN |= m1;
-      else
-        port->PULLUP_EN &= ~m1;
-
-      if (moder == PAL_FE310_MODE_ALTERNATE) {
-        /* If going in alternate mode then the alternate number is set
-           before switching mode in order to avoid glitches.*/
-        port->INPUT_EN &= ~m1;
-        port->OUTPUT_EN &= ~m1;
-        if (altr)
-          port->IOF_SEL |= m1;
-        else
-          port->IOF_SEL &= ~m1;
-        port->IOF_EN |= m1;
-      }
-      else {
-        if (moder == PAL_FE310_MODE_NONE) {
-          port->INPUT_EN &= ~m1;
-          port->OUTPUT_EN &= ~m1;
-        }
-        else {
-          // Both input and output have both input_en and output_en set.
-          port->INPUT_EN |= m1;
-          port->OUTPUT_EN |= m1;
-        }
-        /* If going into a non-alternate mode then the mode is switched
-           before setting the alternate mode in order to avoid glitches.*/
-        port->IOF_EN &= ~m1;
-        port->IOF_SEL &= ~m1;
-      }
-
-      if (ospeedr)
-        port->DRIVE_STR |= m1;
-      else
-        port->DRIVE_STR &= ~m1;
+
+  if (mask == 0U)
+    return;
+
+  if (pupdr)
+    riscv_atomic_or(&port->PULLUP_EN, mask);
+  else
+    riscv_atomic_and(&port->PULLUP_EN, ~mask);
+
+  if (moder == PAL_FE310_MODE_ALTERNATE) {
+    /* If going in alternate mode then the alternate number is set
+       before switching mode in order to avoid glitches.*/
+    riscv_atomic_and(&port->INPUT_EN, ~mask);
+    riscv_atomic_and(&port->OUTPUT_EN, ~mask);
+    if (altr)
+      riscv_atomic_or(&port->IOF_SEL, mask);
+    else
+      riscv_atomic_and(&port->IOF_SEL, ~mask);
+    riscv_atomic_or(&port->IOF_EN, mask);
+  }
+  else {
+    if (moder == PAL_FE310_MODE_NONE) {
+      riscv_atomic_and(&port->INPUT_EN, ~mask);
+      riscv_atomic_and(&port->OUTPUT_EN, ~mask);
+    }
+    else if (moder == PAL_FE310_MODE_INPUT) {
+      riscv_atomic_or(&port->INPUT_EN, mask);
+      riscv_atomic_and(&port->OUTPUT_EN, ~mask);
     }
-    mask >>= 1;
-    if (!mask)
-      return;
-    bit++;
+    else {
+      /* Outputs keep the input enabled, the pad state can be read back.*/
+      riscv_atomic_or(&port->INPUT_EN, mask);
+      riscv_atomic_or(&port->OUTPUT_EN, mask);
+    }
+    /* If going into a non-alternate mode then the mode is switched
+       before setting the alternate mode in order to avoid glitches.*/
+    riscv_atomic_and(&port->IOF_EN, ~mask);
+    riscv_atomic_and(&port->IOF_SEL, ~mask);
+  }
+
+  if (ospeedr)
+    riscv_atomic_or(&port->DRIVE_STR, mask);
+  else
+    riscv_atomic_and(&port->DRIVE_STR, ~mask);
+}
+
+/**
+ * @brief   Returns the mode of a pad.
+ *
+ * @param[in] port      the port identifier
+ * @param[in] pad       the pad number within the port
+ * @return              The pad mode, as accepted by @p palSetPadMode().
+ *
+ * @notapi
+ */
+iomode_t _pal_lld_getpadmode(ioportid_t port, iopadid_t pad) {
+  fe310_gpio_setup_t setup;
+
+  fe310PalSnapshot(port, &setup);
+
+  return fe310PalDecodeMode(&setup, pad);
+}
+
+/**
+ * @brief   Reads the setup of a port.
+ * @details All the configuration registers are read within a single
+ *          critical zone, the snapshot is consistent.
+ *
+ * @param[in] port      the port identifier
+ * @param[out] setup    the port setup
+ *
+ * @xclass
+ */
+void fe310PalSnapshot(ioportid_t port, fe310_gpio_setup_t *setup) {
+  syssts_t sts;
+
+  osalDbgCheck(setup != NULL);
+
+  sts = osalSysGetStatusAndLockX();
+  setup->input_en   = port->INPUT_EN;
+  setup->output_en  = port->OUTPUT_EN;
+  setup->output_val = port->OUTPUT_VAL;
+  setup->pullup_en  = port->PULLUP_EN;
+  setup->drive_str  = port->DRIVE_STR;
+  setup->iof_en     = port->IOF_EN;
+  setup->iof_sel    = port->IOF_SEL;
+  setup->out_xor    = port->OUT_XOR;
+  osalSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Writes the setup of a port.
+ * @details One store per register. The IOFs going away or changing
+ *          selection are released first, the output latch, pull ups,
+ *          drive strength and IOF selection are settled before the pads
+ *          are enabled.
+ * @note    Meant for the startup, the port must not be in use.
+ *
+ * @param[in] port      the port identifier
+ * @param[in] setup     the port setup
+ *
+ * @api
+ */
+void fe310PalApply(ioportid_t port, const fe310_gpio_setup_t *setup) {
+
+  osalDbgCheck(setup != NULL);
+
+  port->IOF_EN     = port->IOF_EN & setup->iof_en &
+                     ~(port->IOF_SEL ^ setup->iof_sel);
+  port->OUTPUT_VAL = setup->output_val;
+  port->OUT_XOR    = setup->out_xor;
+  port->PULLUP_EN  = setup->pullup_en;
+  port->DRIVE_STR  = setup->drive_str;
+  port->IOF_SEL    = setup->iof_sel;
+  port->INPUT_EN   = setup->input_en;
+  port->OUTPUT_EN  = setup->output_en;
+  port->IOF_EN     = setup->iof_en;
+}
+
+/**
+ * @brief   Decodes the mode of a pad from a port setup.
+ *
+ * @param[in] setup     the port setup
+ * @param[in] pad       the pad number within the port
+ * @return              The pad mode, as accepted by @p palSetPadMode().
+ *
+ * @api
+ */
+iomode_t fe310PalDecodeMode(const fe310_gpio_setup_t *setup,
+                            iopadid_t pad) {
+  uint32_t m = 1U << pad;
+  iomode_t mode;
+
+  osalDbgCheck((setup != NULL) && (pad < PAL_IOPORTS_WIDTH));
+
+  if ((setup->iof_en & m) != 0U) {
+    mode = PAL_MODE_ALTERNATE((setup->iof_sel & m) != 0U ? 1U : 0U);
+  }
+  else if ((setup->output_en & m) != 0U) {
+    mode = PAL_FE310_MODE_OUTPUT;
+  }
+  else if ((setup->input_en & m) != 0U) {
+    mode = PAL_FE310_MODE_INPUT;
+  }
+  else {
+    mode = PAL_FE310_MODE_NONE;
+  }
+  if ((setup->pullup_en & m) != 0U) {
+    mode |= PAL_FE310_PUPDR_PULLUP;
+  }
+  if ((setup->drive_str & m) != 0U) {
+    mode |= PAL_FE310_OSPEED_HIGH;
   }
+
+  return mode;
+}
+
+/**
+ * @brief   Compares two port setups.
+ * @details For example a snapshot against @p pal_default_config.
+ *          The output latch is only compared on the pads that are GPIO
+ *          outputs in @p a.
+ *
+ * @param[in] a         the first port setup
+ * @param[in] b         the second port setup
+ * @return              The pads whose setup differs.
+ *
+ * @api
+ */
+ioportmask_t fe310PalDiff(const fe310_gpio_setup_t *a,
+                          const fe310_gpio_setup_t *b) {
+  uint32_t outputs;
+
+  osalDbgCheck((a != NULL) && (b != NULL));
+
+  outputs = a->output_en & ~a->iof_en;
+
+  return (ioportmask_t)((a->input_en  ^ b->input_en)  |
+                        (a->output_en ^ b->output_en) |
+                        (a->pullup_en ^ b->pullup_en) |
+                        (a->drive_str ^ b->drive_str) |
+                        (a->iof_en    ^ b->iof_en)    |
+                        ((a->iof_sel  ^ b->iof_sel) & a->iof_en) |
+                        (a->out_xor   ^ b->out_xor)   |
+                        ((a->output_val ^ b->output_val) & outputs));
+}
+
+#if (PAL_USE_WAIT == TRUE) || (PAL_USE_CALLBACKS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Pad event enable.
+ * @note    Programming an unknown or unsupported mode is silently ignored.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ * @param[in] mode      pad event mode
+ *
+ * @notapi
+ */
+void _pal_lld_enablepadevent(ioportid_t port,
+                             iopadid_t pad,
+                             ioeventmode_t mode) {
+  uint32_t m = 1U << pad;
+
+  osalDbgCheck((port == GPIO0) && (pad < PAL_IOPORTS_WIDTH));
+
+  /* Edges seen before the call are not reported.*/
+  port->RISE_IP = m;
+  port->FALL_IP = m;
+
+  if ((mode & PAL_EVENT_MODE_RISING_EDGE) != 0U)
+    riscv_atomic_or(&port->RISE_IE, m);
+  else
+    riscv_atomic_and(&port->RISE_IE, ~m);
+
+  if ((mode & PAL_EVENT_MODE_FALLING_EDGE) != 0U)
+    riscv_atomic_or(&port->FALL_IE, m);
+  else
+    riscv_atomic_and(&port->FALL_IE, ~m);
+
+  plicEnableInterrupt(FE310_GPIO0_FIRST_NUMBER + pad, FE310_PAL_IRQ_PRIORITY);
+}
+
+/**
+ * @brief   Pad event disable.
+ * @details This function disables previously programmed event callbacks.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ *
+ * @notapi
+ */
+void _pal_lld_disablepadevent(ioportid_t port, iopadid_t pad) {
+  uint32_t m = 1U << pad;
+
+  osalDbgCheck((port == GPIO0) && (pad < PAL_IOPORTS_WIDTH));
+
+  plicDisableInterrupt(FE310_GPIO0_FIRST_NUMBER + pad);
+  riscv_atomic_and(&port->RISE_IE, ~m);
+  riscv_atomic_and(&port->FALL_IE, ~m);
+  port->RISE_IP = m;
+  port->FALL_IP = m;
+
+  _pal_clear_event(pad);
 }
+#endif
 
 #endif /* HAL_USE_PAL == TRUE */
 
@@ -107,6 +107,37 @@
 #define PAL_MODE_OUTPUT_PUSHPULL        PAL_FE310_MODE_OUTPUT
 /** @} */
 
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    FE310 configuration options
+ * @{
+ */
+/**
+ * @brief   GPIO pads interrupt priority level setting.
+ */
+#if !defined(FE310_PAL_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define FE310_PAL_IRQ_PRIORITY              1
+#endif
+
+/**
+ * @brief   Board setup applied by @p palInit().
+ * @details If set to @p TRUE the board must provide
+ *          @p pal_default_config, it is written to the port with one
+ *          store per register.
+ */
+#if !defined(FE310_PAL_USE_DEFAULT_CONFIG) || defined(__DOXYGEN__)
+#define FE310_PAL_USE_DEFAULT_CONFIG        FALSE
+#endif
+/** @} */
+
+#if ((PAL_USE_CALLBACKS == TRUE) || (PAL_USE_WAIT == TRUE)) &&              \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_PAL_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to PAL"
+#endif
+
 /*===========================================================================*/
 /* I/O Ports Types and constants.                                            */
 /*===========================================================================*/
@@ -157,6 +188,22 @@
 #define PAL_NOLINE                      0U
 /** @} */
 
+/**
+ * @brief   GPIO port setup.
+ * @details The configuration registers of a port, as written by
+ *          @p fe310PalApply() and read by @p fe310PalSnapshot().
+ */
+typedef struct {
+  uint32_t                  input_en;
+  uint32_t                  output_en;
+  uint32_t                  output_val;
+  uint32_t                  pullup_en;
+  uint32_t                  drive_str;
+  uint32_t                  iof_en;
+  uint32_t                  iof_sel;
+  uint32_t                  out_xor;
+} fe310_gpio_setup_t;
+
 /**
  * @brief   Generic I/O ports static initializer.
  * @details An instance of this structure must be passed to @p palInit() at
@@ -167,7 +214,10 @@
  *          architecture dependent, fields.
  */
 typedef struct {
-
+  /**
+   * @brief   GPIO0 registers setup.
+   */
+  fe310_gpio_setup_t        GPIO0Data;
 } PALConfig;
 
 /**
@@ -264,7 +314,8 @@ typedef uint32_t iopadid_t;
  *
  * @notapi
  */
-#define pal_lld_setport(port, bits) (riscv_atomic_or (&(port)->OUTPUT_VAL, (uint32_t) bits)
+#define pal_lld_setport(port, bits)                                         \
+  riscv_atomic_or(&(port)->OUTPUT_VAL, (uint32_t)(bits))
 
 /**
  * @brief   Clears a bits mask on a I/O port.
@@ -277,7 +328,61 @@ typedef uint32_t iopadid_t;
  *
  * @notapi
  */
-#define pal_lld_clearport(port, bits) (riscv_atomic_and (&(port)->OUTPUT_VAL, ~((uint32_t) bits))
+#define pal_lld_clearport(port, bits)                                       \
+  riscv_atomic_and(&(port)->OUTPUT_VAL, ~((uint32_t)(bits)))
+
+/**
+ * @brief   Toggles a bits mask on a I/O port.
+ * @note    The @ref PAL provides a default software implementation of this
+ *          functionality, implement this function if can optimize it by using
+ *          special hardware functionalities or special coding.
+ *
+ * @param[in] port      port identifier
+ * @param[in] bits      bits to be XORed on the specified port
+ *
+ * @notapi
+ */
+#define pal_lld_toggleport(port, bits)                                      \
+  riscv_atomic_xor(&(port)->OUTPUT_VAL, (uint32_t)(bits))
+
+/**
+ * @brief   Writes a group of bits.
+ * @details The bits going high are set first, then the bits going low are
+ *          cleared, each pad changes at most once and the other pads are
+ *          not touched.
+ *
+ * @param[in] port      port identifier
+ * @param[in] mask      group mask, a logical AND is performed on the
+ *                      output data
+ * @param[in] offset    group bit offset within the port
+ * @param[in] bits      bits to be written. Values exceeding the group
+ *                      width are masked.
+ *
+ * @notapi
+ */
+#define pal_lld_writegroup(port, mask, offset, bits) do {                   \
+  uint32_t _m = (uint32_t)(mask) << (offset);                               \
+  uint32_t _b = (uint32_t)(bits) << (offset);                               \
+  riscv_atomic_or(&(port)->OUTPUT_VAL, _b & _m);                            \
+  riscv_atomic_and(&(port)->OUTPUT_VAL, ~(~_b & _m));                       \
+} while (false)
+
+/**
+ * @brief   Writes a logical state on an output pad.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ * @param[in] bit       logical value, the value must be @p PAL_LOW or
+ *                      @p PAL_HIGH
+ *
+ * @notapi
+ */
+#define pal_lld_writepad(port, pad, bit) do {                               \
+  if ((bit) != PAL_LOW)                                                     \
+    riscv_atomic_or(&(port)->OUTPUT_VAL, 1U << (pad));                      \
+  else                                                                      \
+    riscv_atomic_and(&(port)->OUTPUT_VAL, ~(1U << (pad)));                  \
+} while (false)
 
 /**
  * @brief   Pads group mode setup.
@@ -295,11 +400,84 @@ typedef uint32_t iopadid_t;
 #define pal_lld_setgroupmode(port, mask, offset, mode)                      \
   _pal_lld_setgroupmode(port, mask << offset, mode)
 
+/**
+ * @brief   Pad event enable.
+ * @note    Programming an unknown or unsupported mode is silently ignored.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ * @param[in] mode      pad event mode
+ *
+ * @notapi
+ */
+#define pal_lld_enablepadevent(port, pad, mode)                             \
+  _pal_lld_enablepadevent(port, pad, mode)
+
+/**
+ * @brief   Pad event disable.
+ * @details This function disables previously programmed event callbacks.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ *
+ * @notapi
+ */
+#define pal_lld_disablepadevent(port, pad)                                  \
+  _pal_lld_disablepadevent(port, pad)
+
+/**
+ * @brief   Returns a PAL event structure associated to a pad.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ *
+ * @notapi
+ */
+#define pal_lld_get_pad_event(port, pad)                                    \
+  &_pal_events[pad]; (void)(port)
+
+/**
+ * @brief   Returns a PAL event structure associated to a line.
+ *
+ * @param[in] line      line identifier
+ *
+ * @notapi
+ */
+#define pal_lld_get_line_event(line)                                        \
+  &_pal_events[PAL_PAD(line)]
+
+/**
+ * @brief   Pad event enable check.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ * @return              Pad event status.
+ * @retval false        if the pad event is disabled.
+ * @retval true         if the pad event is enabled.
+ *
+ * @notapi
+ */
+#define pal_lld_ispadeventenabled(port, pad)                                \
+  (bool)((((port)->RISE_IE | (port)->FALL_IE) & (1U << (uint32_t)(pad))) != 0U)
+
+/**
+ * @brief   Returns the mode of a pad.
+ *
+ * @param[in] port      port identifier
+ * @param[in] pad       pad number within the port
+ * @return              The pad mode.
+ *
+ * @notapi
+ */
+#define pal_lld_getpadmode(port, pad) _pal_lld_getpadmode(port, pad)
 
 #if !defined(__DOXYGEN__)
-// #if (PAL_USE_WAIT == TRUE) || (PAL_USE_CALLBACKS == TRUE)
-// extern palevent_t _pal_events[1];
-// #endif
+#if (PAL_USE_WAIT == TRUE) || (PAL_USE_CALLBACKS == TRUE)
+extern palevent_t _pal_events[PAL_IOPORTS_WIDTH];
+#endif
+#if FE310_PAL_USE_DEFAULT_CONFIG == TRUE
+extern const PALConfig pal_default_config;
+#endif
 #endif
 
 #ifdef __cplusplus
@@ -309,18 +487,35 @@ extern "C" {
   void _pal_lld_setgroupmode(ioportid_t port,
                              ioportmask_t mask,
                              iomode_t mode);
+  void _pal_lld_enablepadevent(ioportid_t port,
+                               iopadid_t pad,
+                               ioeventmode_t mode);
+  void _pal_lld_disablepadevent(ioportid_t port, iopadid_t pad);
+  iomode_t _pal_lld_getpadmode(ioportid_t port, iopadid_t pad);
+  void fe310PalSnapshot(ioportid_t port, fe310_gpio_setup_t *setup);
+  void fe310PalApply(ioportid_t port, const fe310_gpio_setup_t *setup);
+  iomode_t fe310PalDecodeMode(const fe310_gpio_setup_t *setup,
+                              iopadid_t pad);
+  ioportmask_t fe310PalDiff(const fe310_gpio_setup_t *a,
+                            const fe310_gpio_setup_t *b);
 #ifdef __cplusplus
 }
 #endif
 
 static inline void riscv_atomic_or (volatile uint32_t *ptr, uint32_t mask) {
-  asm volatile ("amoor zero, %0, (%1)" : : "r"(ptr), "r"(mask));
+  asm volatile ("amoor zero, %1, (%0)" : : "r"(ptr), "r"(mask) : "memory");
 }
 
 static inline void riscv_atomic_and (volatile uint32_t *ptr, uint32_t mask) {
-  asm volatile ("amoand zero, %0, (%1)" : : "r"(ptr), "r"(mask));
+  asm volatile ("amoand zero, %1, (%0)" : : "r"(ptr), "r"(mask) : "memory");
 }
 
+static inline void riscv_atomic_xor (volatile uint32_t *ptr, uint32_t mask) {
+  asm volatile ("amoxor zero, %1, (%0)" : : "r"(ptr), "r"(mask) : "memory");
+}
+
+#include "fe310_input.h"
+
 #endif /* HAL_USE_PAL == TRUE */
 
 #endif /* HAL_PAL_LLD_H */
@@ -30,6 +30,12 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if FE310_SERIAL_USE_STATISTICS || defined(__DOXYGEN__)
+#define SD_STAT_ADD(sdp, field, n)          ((sdp)->stats.field += (n))
+#else
+#define SD_STAT_ADD(sdp, field, n)
+#endif
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -48,17 +54,151 @@ SerialDriver SD1;
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+#if (FE310_SERIAL_USE_UART0 == TRUE) || defined(__DOXYGEN__)
+/** @brief UART0 input queue buffer.*/
+static uint8_t sd_in_buf0[FE310_SERIAL_UART0_IN_BUF_SIZE];
+
+/** @brief UART0 output queue buffer.*/
+static uint8_t sd_out_buf0[FE310_SERIAL_UART0_OUT_BUF_SIZE];
+#endif
+
+#if (FE310_SERIAL_USE_UART1 == TRUE) || defined(__DOXYGEN__)
+/** @brief UART1 input queue buffer.*/
+static uint8_t sd_in_buf1[FE310_SERIAL_UART1_IN_BUF_SIZE];
+
+/** @brief UART1 output queue buffer.*/
+static uint8_t sd_out_buf1[FE310_SERIAL_UART1_OUT_BUF_SIZE];
+#endif
+
 /**
  * @brief   Driver default configuration.
  */
 static const SerialConfig default_config = {
-  SERIAL_DEFAULT_BITRATE
+  SERIAL_DEFAULT_BITRATE,
+  1,
+  0,
+  1,
+  1
 };
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Programs the divisor for a bit rate.
+ * @details The divisor is rounded to the nearest value, the obtained bit
+ *          rate is stored in the driver.
+ *
+ * @param[in] sdp       communication channel associated to the UART
+ * @param[in] speed     required bit rate
+ */
+static void set_speed(SerialDriver *sdp, uint32_t speed) {
+  uint32_t div;
+
+  osalDbgCheck(speed > 0U);
+
+  div = UART_DIV_ROUND(FE310_CORECLK, speed);
+  osalDbgAssert((div >= UART_DIV_MIN) && (div <= UART_DIV_DIV_MASK),
+                "bit rate out of range");
+  osalDbgAssert(UART_BAUD_ERROR(FE310_CORECLK, speed) <=
+                FE310_SERIAL_MAX_BAUD_ERROR, "bit rate error too large");
+
+  sdp->baud = UART_DIV_BAUD(FE310_CORECLK, div);
+  sdp->uart->DIV = UART_DIV_DIV(div);
+}
+
+/**
+ * @brief   Inserts a burst of bytes into the input queue.
+ * @details Bulk version of @p sdIncomingDataI(), the flags are broadcast
+ *          and the readers woken once for the whole burst.
+ *
+ * @param[in] sdp       communication channel associated to the UART
+ * @param[in] bp        pointer to the received bytes
+ * @param[in] n         number of received bytes
+ *
+ * @iclass
+ */
+static void rx_insert_burst(SerialDriver *sdp, const uint8_t *bp, size_t n) {
+  input_queue_t *iqp = &sdp->iqueue;
+  size_t space = iqGetEmptyI(iqp);
+
+  SD_STAT_ADD(sdp, rxbytes, n);
+  if (n > space) {
+    chnAddFlagsI(sdp, SD_QUEUE_FULL_ERROR);
+    SD_STAT_ADD(sdp, overflows, 1U);
+    SD_STAT_ADD(sdp, lost, n - space);
+    n = space;
+  }
+  if (n == 0U)
+    return;
+
+  if (iqIsEmptyI(iqp))
+    chnAddFlagsI(sdp, CHN_INPUT_AVAILABLE);
+
+  iqp->q_counter += n;
+  while (n > 0U) {
+    *iqp->q_wrptr++ = *bp++;
+    if (iqp->q_wrptr >= iqp->q_top)
+      iqp->q_wrptr = iqp->q_buffer;
+    n--;
+  }
+
+  osalThreadDequeueAllI(&iqp->q_waiting, MSG_OK);
+}
+
+/**
+ * @brief   Moves the content of the RX FIFO into the input queue.
+ * @details The FIFO is drained into a local buffer first, bytes arriving
+ *          meanwhile make another burst.
+ *
+ * @param[in] sdp       communication channel associated to the UART
+ * @return              The number of bytes moved.
+ *
+ * @iclass
+ */
+static size_t serve_rx(SerialDriver *sdp) {
+  fe310_uart_t *u = sdp->uart;
+  uint8_t buf[UART_FIFO_SIZE];
+  uint32_t data;
+  size_t total = 0;
+  size_t n;
+
+  do {
+    n = 0;
+    while ((n < UART_FIFO_SIZE) &&
+           !((data = u->RXDATA) & UART_RXDATA_EMPTY)) {
+      buf[n++] = (uint8_t) data;
+    }
+    rx_insert_burst(sdp, buf, n);
+    total += n;
+  } while (n == UART_FIFO_SIZE);
+
+  return total;
+}
+
+/**
+ * @brief   RX idle timer callback.
+ * @details Flushes the bytes left below the watermark. After a gap with no
+ *          data the watermark goes back to one byte, so the first byte of
+ *          the next burst is not delayed.
+ *
+ * @param[in] p         communication channel associated to the UART
+ */
+static void rx_idle_cb(void *p) {
+  SerialDriver *sdp = (SerialDriver *)p;
+
+  osalSysLockFromISR();
+  if ((serve_rx(sdp) > 0U) || sdp->rxactive) {
+    sdp->rxactive = false;
+    chVTSetI(&sdp->rxvt, sdp->rxidle, rx_idle_cb, sdp);
+  }
+  else {
+    sdp->uart->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(0);
+  }
+  osalSysUnlockFromISR();
+}
+
 /**
  * @brief   Common IRQ handler.
  *
@@ -68,49 +208,75 @@ static void serve_interrupt(SerialDriver *sdp) {
   fe310_uart_t *u = sdp->uart;
   uint32_t ie = u->IE;
   uint32_t ip = u->IP;
+#if FE310_SERIAL_USE_STATISTICS
+  uint32_t start, end;
+
+  RISCV_CSR_READ(start, mcycle);
+#endif
 
   /* Data available.*/
   osalSysLockFromISR();
   if ((ie & UART_IE_RXWM) && (ip & UART_IP_RXWM)) {
-    uint32_t data;
-    while (!((data = u->RXDATA) & UART_RXDATA_EMPTY)) {
-      sdIncomingDataI(sdp, (uint8_t) data);
+    (void) serve_rx(sdp);
+
+    /* The rest of the burst is coalesced, the idle timer flushes it.*/
+    if (sdp->rxwm > 0U) {
+      sdp->rxactive = true;
+      if (!chVTIsArmedI(&sdp->rxvt)) {
+        u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(sdp->rxwm - 1U);
+        chVTSetI(&sdp->rxvt, sdp->rxidle, rx_idle_cb, sdp);
+      }
     }
   }
   osalSysUnlockFromISR();
 
   /* Transmission buffer empty.*/
   if ((ie & UART_IE_TXWM) && (ip & UART_IP_TXWM)) {
+    size_t n = 0;
     msg_t b;
     osalSysLockFromISR();
-    // The first byte is special. If it is missing, disable the interrupt.
-    b = oqGetI(&sdp->oqueue);
-    if (b < MSG_OK) {
+    // The watermark guarantees room for the first byte. The output queue
+    // goes first, then the caller buffer of a direct write.
+    do {
+      b = oqGetI(&sdp->oqueue);
+#if FE310_SERIAL_USE_DIRECT_TX
+      if ((b < MSG_OK) && (sdp->txn > 0U)) {
+        b = (msg_t)*sdp->txbuf++;
+        if (--sdp->txn == 0U)
+          osalThreadResumeI(&sdp->txthread, MSG_OK);
+      }
+#endif
+      if (b < MSG_OK)
+        break;
+      u->TXDATA = (uint8_t) b;
+      n++;
+    } while (!(u->TXDATA & UART_TXDATA_FULL));
+    SD_STAT_ADD(sdp, txbytes, n);
+
+    // If the first byte is missing, disable the interrupt.
+    if (n == 0U) {
       // TX End is an unknown with this peripheral.
       // Nasty hack to just send TX end with empty.
       chnAddFlagsI(sdp, CHN_OUTPUT_EMPTY);
       chnAddFlagsI(sdp, CHN_TRANSMISSION_END);
       u->IE &= ~UART_IE_TXWM;
     }
-    else
-    {
-      u->TXDATA = (uint8_t) b;
-      while (!(u->TXDATA & UART_TXDATA_FULL)) {
-        b = oqGetI(&sdp->oqueue);
-        if (b < MSG_OK)
-          break;
-        u->TXDATA = (uint8_t) b;
-      }
-    }
     osalSysUnlockFromISR();
   }
+
+#if FE310_SERIAL_USE_STATISTICS
+  RISCV_CSR_READ(end, mcycle);
+  sdp->stats.isrs++;
+  sdp->stats.cycles += end - start;
+#endif
 }
 
 #if FE310_SERIAL_USE_UART0 == TRUE
 static void notify0(io_queue_t *qp) {
 
   (void) qp;
-  UART0->IE |= UART_IE_TXWM;
+  if (!SD0.txpaused)
+    UART0->IE |= UART_IE_TXWM;
 }
 #endif
 
@@ -118,7 +284,8 @@ static void notify0(io_queue_t *qp) {
 static void notify1(io_queue_t *qp) {
 
   (void) qp;
-  UART1->IE |= UART_IE_TXWM;
+  if (!SD1.txpaused)
+    UART1->IE |= UART_IE_TXWM;
 }
 #endif
 
@@ -177,12 +344,30 @@ void sd_lld_init(void) {
 
 #if FE310_SERIAL_USE_UART0 == TRUE
   sdObjectInit(&SD0, NULL, notify0);
+  iqObjectInit(&SD0.iqueue, sd_in_buf0, sizeof (sd_in_buf0), NULL, &SD0);
+  oqObjectInit(&SD0.oqueue, sd_out_buf0, sizeof (sd_out_buf0),
+               notify0, &SD0);
   SD0.uart = UART0;
+  chVTObjectInit(&SD0.rxvt);
+#if FE310_SERIAL_USE_DIRECT_TX
+  SD0.txbuf    = NULL;
+  SD0.txn      = 0U;
+  SD0.txthread = NULL;
+#endif
 #endif
 
 #if FE310_SERIAL_USE_UART1 == TRUE
   sdObjectInit(&SD1, NULL, notify1);
+  iqObjectInit(&SD1.iqueue, sd_in_buf1, sizeof (sd_in_buf1), NULL, &SD1);
+  oqObjectInit(&SD1.oqueue, sd_out_buf1, sizeof (sd_out_buf1),
+               notify1, &SD1);
   SD1.uart = UART1;
+  chVTObjectInit(&SD1.rxvt);
+#if FE310_SERIAL_USE_DIRECT_TX
+  SD1.txbuf    = NULL;
+  SD1.txn      = 0U;
+  SD1.txthread = NULL;
+#endif
 #endif
 }
 
@@ -225,14 +410,33 @@ void sd_lld_start(SerialDriver *sdp, const SerialConfig *config) {
 
   /* Configures the peripheral.*/
   /* Baud rate setting.*/
-  u->DIV = UART_DIV_DIV ((FE310_CORECLK / config->speed) - 1);
-
-  /* Enable transmitting with a watermark meaning empty.*/
-  /* TODO: stop bits.*/
-  u->TXCTRL = UART_TXCTRL_TXEN | UART_TXCTRL_NSTOP_1 | UART_TXCTRL_TXCNT(1);
+  set_speed(sdp, config->speed);
+
+  /* Enable transmitting, the watermark is the FIFO refill level.*/
+  osalDbgCheck((config->txwm < UART_FIFO_SIZE) && (config->stopbits <= 2U));
+  u->TXCTRL = UART_TXCTRL_TXEN |
+              (config->stopbits == 2U ? UART_TXCTRL_NSTOP_2 :
+                                        UART_TXCTRL_NSTOP_1) |
+              UART_TXCTRL_TXCNT(config->txwm > 0U ? config->txwm : 1U);
+
+  /* RX coalescing settings, a watermark of one does not need it.*/
+  osalDbgCheck(config->rxwm <= 8U);
+  osalDbgCheck((config->rxwm <= 1U) || (config->rxidle > (sysinterval_t)0));
+  if ((config->rxwm > 1U) && (config->rxidle > (sysinterval_t)0)) {
+    sdp->rxwm   = config->rxwm;
+    sdp->rxidle = config->rxidle;
+  }
+  else {
+    sdp->rxwm   = 0U;
+  }
+  sdp->rxactive = false;
+  sdp->txpaused = false;
+  if (chVTIsArmedI(&sdp->rxvt))
+    chVTResetI(&sdp->rxvt);
 
-  /* Enable receiving with a watermark meaning data is present.*/
-  u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(1);
+  /* Enable receiving with a watermark meaning data is present, the RX
+     interrupt is raised when the FIFO holds more than RXCNT bytes.*/
+  u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(0);
 
   /* Enable receive interrupt only.*/
   u->IE = UART_IE_RXWM;
@@ -254,6 +458,11 @@ void sd_lld_stop(SerialDriver *sdp) {
   if (sdp->state == SD_READY) {
     /* Disable interrupts.*/
     u->IE = 0;
+    if (chVTIsArmedI(&sdp->rxvt))
+      chVTResetI(&sdp->rxvt);
+#if FE310_SERIAL_USE_DIRECT_TX
+    osalThreadResumeI(&sdp->txthread, MSG_RESET);
+#endif
 
     /* Stop all actions.*/
     u->TXCTRL = 0;
@@ -279,6 +488,157 @@ void sd_lld_stop(SerialDriver *sdp) {
   }
 }
 
+/**
+ * @brief   Changes the bit rate of a running serial driver.
+ * @details The queues are not touched. Transmission is paused until the
+ *          TX FIFO has been shifted out, so the bytes already handed to
+ *          the UART go at the old rate and the queued ones at the new rate.
+ * @note    Frames being received during the change can be corrupted.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] speed     the new bit rate
+ *
+ * @api
+ */
+void fe310SerialSetSpeed(SerialDriver *sdp, uint32_t speed) {
+  fe310_uart_t *u = sdp->uart;
+  uint32_t txctrl;
+  sysinterval_t frame;
+
+  osalDbgCheck((sdp != NULL) && (speed > 0U));
+  osalDbgAssert(sdp->state == SD_READY, "invalid state");
+
+  /* Frame time at the old rate, 11 bits at most.*/
+  frame = TIME_US2I(((11U * 1000000U) + sdp->baud - 1U) / sdp->baud);
+
+  /* The ISR stops feeding the FIFO, the watermark now means empty.*/
+  osalSysLock();
+  sdp->txpaused = true;
+  u->IE &= ~UART_IE_TXWM;
+  txctrl = u->TXCTRL;
+  u->TXCTRL = (txctrl & ~UART_TXCTRL_TXCNT(UART_TXCTRL_TXCNT_MASK)) |
+              UART_TXCTRL_TXCNT(1);
+  osalSysUnlock();
+
+  /* Polled once per frame time, the FIFO takes up to eight of them.*/
+  while ((u->IP & UART_IP_TXWM) == 0U) {
+    osalThreadSleep(frame);
+  }
+
+  /* The last frame is still in the shift register.*/
+  osalThreadSleep(frame);
+
+  osalSysLock();
+  set_speed(sdp, speed);
+  u->TXCTRL = txctrl;
+  sdp->txpaused = false;
+#if FE310_SERIAL_USE_DIRECT_TX
+  if (!oqIsEmptyI(&sdp->oqueue) || (sdp->txn > 0U))
+#else
+  if (!oqIsEmptyI(&sdp->oqueue))
+#endif
+    u->IE |= UART_IE_TXWM;
+  osalSysUnlock();
+}
+
+#if FE310_SERIAL_USE_DIRECT_TX || defined(__DOXYGEN__)
+/**
+ * @brief   Writes a buffer without copying it into the output queue.
+ * @details The ISR moves the bytes from the buffer into the TX FIFO after
+ *          the output queue has been emptied, so data already queued is
+ *          sent first. The caller sleeps until the last byte is in the
+ *          FIFO, the buffer can then be reused.
+ * @note    Writes shorter than @p FE310_SERIAL_DIRECT_TX_THRESHOLD, or
+ *          than the output queue size when that is zero, and writes
+ *          issued while another direct write is in progress, go through
+ *          the output queue. As with @p chnWriteTimeout(),
+ *          concurrent writers must be serialized by the caller.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         number of bytes to be written
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes moved to the TX FIFO, less
+ *                      than @p n on timeout or driver stop.
+ *
+ * @api
+ */
+size_t fe310SerialWriteTimeout(SerialDriver *sdp, const uint8_t *bp,
+                               size_t n, sysinterval_t timeout) {
+
+  size_t threshold;
+
+  osalDbgCheck((sdp != NULL) && ((bp != NULL) || (n == 0U)));
+
+#if FE310_SERIAL_DIRECT_TX_THRESHOLD > 0
+  threshold = FE310_SERIAL_DIRECT_TX_THRESHOLD;
+#else
+  threshold = qSizeX(&sdp->oqueue);
+#endif
+  if (n < threshold)
+    return chnWriteTimeout(sdp, bp, n, timeout);
+
+  osalSysLock();
+  osalDbgAssert(sdp->state == SD_READY, "invalid state");
+  if (sdp->txn > 0U) {
+    osalSysUnlock();
+    return chnWriteTimeout(sdp, bp, n, timeout);
+  }
+
+  sdp->txbuf = bp;
+  sdp->txn   = n;
+  if (!sdp->txpaused)
+    sdp->uart->IE |= UART_IE_TXWM;
+  if (osalThreadSuspendTimeoutS(&sdp->txthread, timeout) != MSG_OK) {
+    n -= sdp->txn;
+    sdp->txn = 0U;
+  }
+  osalSysUnlock();
+
+  return n;
+}
+#endif
+
+#if FE310_SERIAL_USE_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a snapshot of the driver statistics.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[out] stp      the statistics counters
+ *
+ * @api
+ */
+void fe310SerialGetStatistics(SerialDriver *sdp, fe310_serial_stats_t *stp) {
+
+  osalDbgCheck((sdp != NULL) && (stp != NULL));
+
+  osalSysLock();
+  *stp = sdp->stats;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Clears the driver statistics.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ *
+ * @api
+ */
+void fe310SerialResetStatistics(SerialDriver *sdp) {
+  static const fe310_serial_stats_t zero = {0};
+
+  osalDbgCheck(sdp != NULL);
+
+  osalSysLock();
+  sdp->stats = zero;
+  osalSysUnlock();
+}
+#endif
+
 #endif /* HAL_USE_SERIAL == TRUE */
 
 /** @} */
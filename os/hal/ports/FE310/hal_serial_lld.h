@@ -58,16 +58,136 @@
 #if !defined(FE310_SERIAL_USE_UART1) || defined(__DOXYGEN__)
 #define FE310_SERIAL_USE_UART1              FALSE
 #endif
+
+/**
+ * @brief   UART0 input buffer size.
+ */
+#if !defined(FE310_SERIAL_UART0_IN_BUF_SIZE) || defined(__DOXYGEN__)
+#define FE310_SERIAL_UART0_IN_BUF_SIZE      SERIAL_BUFFERS_SIZE
+#endif
+
+/**
+ * @brief   UART0 output buffer size.
+ */
+#if !defined(FE310_SERIAL_UART0_OUT_BUF_SIZE) || defined(__DOXYGEN__)
+#define FE310_SERIAL_UART0_OUT_BUF_SIZE     SERIAL_BUFFERS_SIZE
+#endif
+
+/**
+ * @brief   UART1 input buffer size.
+ */
+#if !defined(FE310_SERIAL_UART1_IN_BUF_SIZE) || defined(__DOXYGEN__)
+#define FE310_SERIAL_UART1_IN_BUF_SIZE      SERIAL_BUFFERS_SIZE
+#endif
+
+/**
+ * @brief   UART1 output buffer size.
+ */
+#if !defined(FE310_SERIAL_UART1_OUT_BUF_SIZE) || defined(__DOXYGEN__)
+#define FE310_SERIAL_UART1_OUT_BUF_SIZE     SERIAL_BUFFERS_SIZE
+#endif
+
+/**
+ * @brief   Maximum bit rate error, in tenths of percent.
+ * @details Bit rates whose rounded divisor is off by more than this are
+ *          rejected, at compile time for @p SERIAL_DEFAULT_BITRATE and by
+ *          a debug assertion otherwise.
+ */
+#if !defined(FE310_SERIAL_MAX_BAUD_ERROR) || defined(__DOXYGEN__)
+#define FE310_SERIAL_MAX_BAUD_ERROR         20
+#endif
+
+/**
+ * @brief   Driver statistics switch.
+ * @details If set to @p TRUE the drivers count interrupts, the cycles
+ *          spent serving them and the bytes moved, see
+ *          @p fe310SerialGetStatistics().
+ */
+#if !defined(FE310_SERIAL_USE_STATISTICS) || defined(__DOXYGEN__)
+#define FE310_SERIAL_USE_STATISTICS         FALSE
+#endif
+
+/**
+ * @brief   Direct transmission switch.
+ * @details If set to @p TRUE @p fe310SerialWriteTimeout() feeds the TX
+ *          FIFO straight from the caller buffer instead of copying it
+ *          into the output queue.
+ */
+#if !defined(FE310_SERIAL_USE_DIRECT_TX) || defined(__DOXYGEN__)
+#define FE310_SERIAL_USE_DIRECT_TX          FALSE
+#endif
+
+/**
+ * @brief   Smallest write sent directly from the caller buffer.
+ * @details Shorter writes go through the output queue, the caller is not
+ *          suspended for them when the queue has room. Zero means the
+ *          output queue size of each UART.
+ */
+#if !defined(FE310_SERIAL_DIRECT_TX_THRESHOLD) || defined(__DOXYGEN__)
+#define FE310_SERIAL_DIRECT_TX_THRESHOLD    0
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (FE310_SERIAL_UART0_IN_BUF_SIZE < 1) ||                                \
+    (FE310_SERIAL_UART0_OUT_BUF_SIZE < 1) ||                               \
+    (FE310_SERIAL_UART1_IN_BUF_SIZE < 1) ||                                \
+    (FE310_SERIAL_UART1_OUT_BUF_SIZE < 1)
+#error "invalid serial buffer size"
+#endif
+
+#if UART_BAUD_ERROR(FE310_CORECLK, SERIAL_DEFAULT_BITRATE) >                 \
+    FE310_SERIAL_MAX_BAUD_ERROR
+#error "SERIAL_DEFAULT_BITRATE cannot be obtained from FE310_CORECLK"
+#endif
+
+#if UART_DIV_ROUND(FE310_CORECLK, SERIAL_DEFAULT_BITRATE) < UART_DIV_MIN
+#error "SERIAL_DEFAULT_BITRATE too high for FE310_CORECLK"
+#endif
+
+#if UART_DIV_ROUND(FE310_CORECLK, SERIAL_DEFAULT_BITRATE) > UART_DIV_DIV_MASK
+#error "SERIAL_DEFAULT_BITRATE too low for FE310_CORECLK"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+#if FE310_SERIAL_USE_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Serial driver statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Interrupts served.
+   */
+  uint32_t                  isrs;
+  /**
+   * @brief   @p mcycle ticks spent in the interrupt handler.
+   */
+  uint64_t                  cycles;
+  /**
+   * @brief   Bytes received, including the lost ones.
+   */
+  uint32_t                  rxbytes;
+  /**
+   * @brief   Bytes transmitted.
+   */
+  uint32_t                  txbytes;
+  /**
+   * @brief   Bursts that found the input queue full.
+   */
+  uint32_t                  overflows;
+  /**
+   * @brief   Bytes lost because the input queue was full.
+   */
+  uint32_t                  lost;
+} fe310_serial_stats_t;
+#endif
+
 /**
  * @brief   FE310 Serial Driver configuration structure.
  * @details An instance of this structure must be passed to @p sdStart()
@@ -82,6 +202,27 @@ typedef struct {
    */
   uint32_t                  speed;
   /* End of the mandatory fields.*/
+  /**
+   * @brief RX watermark, bytes received before an interrupt is raised.
+   * @note  Values above one require @p rxidle, zero means one.
+   */
+  uint8_t                   rxwm;
+  /**
+   * @brief RX idle timeout.
+   * @details Bytes below the watermark are flushed when no interrupt
+   *          happened for this interval, zero disables coalescing.
+   */
+  sysinterval_t             rxidle;
+  /**
+   * @brief TX watermark, the FIFO is refilled when it holds fewer bytes
+   *        than this, 1..7, zero means one.
+   * @note  Higher values avoid gaps between frames at high bit rates.
+   */
+  uint8_t                   txwm;
+  /**
+   * @brief Stop bits, 1 or 2, zero means one.
+   */
+  uint8_t                   stopbits;
 } SerialConfig;
 
 /**
@@ -95,18 +236,68 @@ typedef struct {
   input_queue_t             iqueue;                                         \
   /* Output queue.*/                                                        \
   output_queue_t            oqueue;                                         \
-  /* Input circular buffer.*/                                               \
-  uint8_t                   ib[SERIAL_BUFFERS_SIZE];                        \
-  /* Output circular buffer.*/                                              \
-  uint8_t                   ob[SERIAL_BUFFERS_SIZE];                        \
+  /* Placeholders for sdObjectInit(), the queues are then moved to the     \
+     per-instance buffers.*/                                                \
+  uint8_t                   ib[1];                                          \
+  uint8_t                   ob[1];                                          \
   /* End of the mandatory fields.*/                                         \
   /* Pointer to the UART instance.*/                                        \
-  fe310_uart_t              *uart;
+  fe310_uart_t              *uart;                                          \
+  /* Bit rate actually obtained.*/                                          \
+  uint32_t                  baud;                                           \
+  /* Transmission paused by a bit rate change.*/                            \
+  bool                      txpaused;                                       \
+  /* RX watermark, zero if coalescing is disabled.*/                        \
+  uint8_t                   rxwm;                                           \
+  /* Data received since the last idle timer expiration.*/                 \
+  bool                      rxactive;                                       \
+  /* RX idle timeout.*/                                                     \
+  sysinterval_t             rxidle;                                         \
+  /* RX idle timer.*/                                                       \
+  virtual_timer_t           rxvt;                                           \
+  /* Driver statistics.*/                                                   \
+  _fe310_serial_stats_field                                                 \
+  /* Direct transmission state.*/                                           \
+  _fe310_serial_direct_tx_fields
+
+#if FE310_SERIAL_USE_STATISTICS || defined(__DOXYGEN__)
+#define _fe310_serial_stats_field                                           \
+  fe310_serial_stats_t      stats;
+#else
+#define _fe310_serial_stats_field
+#endif
+
+#if FE310_SERIAL_USE_DIRECT_TX || defined(__DOXYGEN__)
+#define _fe310_serial_direct_tx_fields                                      \
+  /* Caller buffer being transmitted.*/                                     \
+  const uint8_t             *txbuf;                                         \
+  /* Bytes of the caller buffer not yet in the FIFO.*/                      \
+  size_t                    txn;                                            \
+  /* Writer waiting for the caller buffer to be consumed.*/                 \
+  thread_reference_t        txthread;
+#else
+#define _fe310_serial_direct_tx_fields
+#endif
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+#if FE310_SERIAL_USE_DIRECT_TX || defined(__DOXYGEN__)
+/**
+ * @brief   Direct write without timeout.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         number of bytes to be written
+ * @return              The number of bytes written.
+ *
+ * @api
+ */
+#define fe310SerialWrite(sdp, bp, n)                                        \
+  fe310SerialWriteTimeout(sdp, bp, n, TIME_INFINITE)
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -125,6 +316,15 @@ extern "C" {
   void sd_lld_init(void);
   void sd_lld_start(SerialDriver *sdp, const SerialConfig *config);
   void sd_lld_stop(SerialDriver *sdp);
+  void fe310SerialSetSpeed(SerialDriver *sdp, uint32_t speed);
+#if FE310_SERIAL_USE_DIRECT_TX
+  size_t fe310SerialWriteTimeout(SerialDriver *sdp, const uint8_t *bp,
+                                 size_t n, sysinterval_t timeout);
+#endif
+#if FE310_SERIAL_USE_STATISTICS
+  void fe310SerialGetStatistics(SerialDriver *sdp, fe310_serial_stats_t *stp);
+  void fe310SerialResetStatistics(SerialDriver *sdp);
+#endif
 #ifdef __cplusplus
 }
 #endif
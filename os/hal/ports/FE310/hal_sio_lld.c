@@ -0,0 +1,595 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_sio_lld.c
+ * @brief   FE310 SIO subsystem low level driver source.
+ *
+ * @addtogroup SIO
+ * @{
+ */
+
+#include "hal.h"
+
+#if (HAL_USE_SIO == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief UART0 SIO driver identifier.*/
+#if (FE310_SIO_USE_UART0 == TRUE) || defined(__DOXYGEN__)
+SIODriver SIOD0;
+#endif
+
+/** @brief UART1 SIO driver identifier.*/
+#if (FE310_SIO_USE_UART1 == TRUE) || defined(__DOXYGEN__)
+SIODriver SIOD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the configured RX watermark.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              The watermark, 1..8.
+ */
+static inline uint32_t sio_rxwm(SIODriver *siop) {
+
+  return siop->config->rxwm > 0U ? siop->config->rxwm : 1U;
+}
+
+/**
+ * @brief   Returns the configured TX watermark.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              The watermark, 1..7.
+ */
+static inline uint32_t sio_txwm(SIODriver *siop) {
+
+  return siop->config->txwm > 0U ? siop->config->txwm : 1U;
+}
+
+/**
+ * @brief   Tells if the idle timer is used.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              @p true if an idle callback and timeout are set.
+ */
+static inline bool sio_uses_idle(SIODriver *siop) {
+
+  return (siop->operation != NULL) &&
+         (siop->operation->rx_idle_cb != NULL) &&
+         (siop->config->rxidle > (sysinterval_t)0);
+}
+
+/**
+ * @brief   Enables the RX interrupt again after a read.
+ * @details Without an RX callback the watermark tracks the FIFO level,
+ *          it is restarted from zero, the remaining frames raise at most
+ *          one interrupt each.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ */
+static void sio_rearm_rx(SIODriver *siop) {
+  syssts_t sts;
+
+  if ((siop->operation == NULL) ||
+      ((siop->operation->rx_cb == NULL) &&
+       (siop->operation->rx_idle_cb == NULL))) {
+    return;
+  }
+
+  sts = osalSysGetStatusAndLockX();
+  if (siop->operation->rx_cb == NULL) {
+    siop->uart->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(0);
+  }
+  siop->uart->IE |= UART_IE_RXWM;
+  osalSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Enables the TX interrupt after data has been queued.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ */
+static void sio_rearm_tx(SIODriver *siop) {
+  fe310_uart_t *u = siop->uart;
+  syssts_t sts;
+
+  if ((siop->operation == NULL) ||
+      ((siop->operation->tx_cb == NULL) &&
+       (siop->operation->tx_end_cb == NULL))) {
+    return;
+  }
+
+  sts = osalSysGetStatusAndLockX();
+  if (siop->txend) {
+    /* New data, the end of transmission is not there yet.*/
+    siop->txend = false;
+    u->TXCTRL = (u->TXCTRL & ~UART_TXCTRL_TXCNT(UART_TXCTRL_TXCNT_MASK)) |
+                UART_TXCTRL_TXCNT(sio_txwm(siop));
+  }
+  u->IE |= UART_IE_TXWM;
+  osalSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   RX idle timer callback.
+ * @details The RX idle callback is invoked after a gap with no RX
+ *          interrupts. With an RX callback the watermark goes back to one
+ *          byte so the first byte of the next burst is not delayed.
+ *
+ * @param[in] p         pointer to the @p SIODriver object
+ */
+static void sio_rx_idle_cb(void *p) {
+  SIODriver *siop = (SIODriver *)p;
+  fe310_uart_t *u = siop->uart;
+
+  osalSysLockFromISR();
+  if (siop->rxactive) {
+    siop->rxactive = false;
+    chVTSetI(&siop->rxvt, siop->config->rxidle, sio_rx_idle_cb, siop);
+    osalSysUnlockFromISR();
+    return;
+  }
+  if ((siop->operation != NULL) && (siop->operation->rx_cb != NULL)) {
+    u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(0);
+  }
+  osalSysUnlockFromISR();
+
+  if (sio_uses_idle(siop))
+    siop->operation->rx_idle_cb(siop);
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+#if FE310_SIO_USE_UART0 || defined(__DOXYGEN__)
+#if !defined(FE310_UART0_HANDLER)
+#error "FE310_UART0_HANDLER not defined"
+#endif
+/**
+ * @brief   UART0 interrupt handler.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(FE310_UART0_HANDLER) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  sio_lld_serve_interrupt(&SIOD0);
+
+  OSAL_IRQ_EPILOGUE();
+}
+#endif
+
+#if FE310_SIO_USE_UART1 || defined(__DOXYGEN__)
+#if !defined(FE310_UART1_HANDLER)
+#error "FE310_UART1_HANDLER not defined"
+#endif
+/**
+ * @brief   UART1 interrupt handler.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(FE310_UART1_HANDLER) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  sio_lld_serve_interrupt(&SIOD1);
+
+  OSAL_IRQ_EPILOGUE();
+}
+#endif
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SIO driver initialization.
+ *
+ * @notapi
+ */
+void sio_lld_init(void) {
+
+#if FE310_SIO_USE_UART0 == TRUE
+  sioObjectInit(&SIOD0);
+  SIOD0.uart = UART0;
+  chVTObjectInit(&SIOD0.rxvt);
+#endif
+
+#if FE310_SIO_USE_UART1 == TRUE
+  sioObjectInit(&SIOD1);
+  SIOD1.uart = UART1;
+  chVTObjectInit(&SIOD1.rxvt);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the SIO peripheral.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              The operation status.
+ * @retval false        if the driver has been correctly started.
+ * @retval true         if an error occurred.
+ *
+ * @notapi
+ */
+bool sio_lld_start(SIODriver *siop) {
+  fe310_uart_t *u = siop->uart;
+  uint32_t div;
+
+  osalDbgCheck((siop->config->baud > 0U) &&
+               (siop->config->rxwm <= UART_FIFO_SIZE) &&
+               (siop->config->txwm < UART_FIFO_SIZE));
+
+  div = UART_DIV_ROUND(FE310_CORECLK, siop->config->baud);
+  osalDbgAssert((div >= UART_DIV_MIN) && (div <= UART_DIV_DIV_MASK),
+                "bit rate out of range");
+  osalDbgAssert(UART_BAUD_ERROR(FE310_CORECLK, siop->config->baud) <=
+                FE310_SIO_MAX_BAUD_ERROR, "bit rate error too large");
+
+  if (siop->state == SIO_STOP) {
+    if (false) {
+    }
+#if FE310_SIO_USE_UART0 == TRUE
+    else if (siop == &SIOD0) {
+      plicEnableInterrupt(FE310_UART0_NUMBER, FE310_SIO_UART0_IRQ_PRIORITY);
+    }
+#endif
+#if FE310_SIO_USE_UART1 == TRUE
+    else if (siop == &SIOD1) {
+      plicEnableInterrupt(FE310_UART1_NUMBER, FE310_SIO_UART1_IRQ_PRIORITY);
+    }
+#endif
+    else {
+      osalDbgAssert(false, "invalid SIO instance");
+    }
+  }
+
+  u->IE = 0;
+  u->DIV = UART_DIV_DIV(div);
+  u->TXCTRL = UART_TXCTRL_TXEN | UART_TXCTRL_NSTOP_1 |
+              UART_TXCTRL_TXCNT(sio_txwm(siop));
+
+  /* The rxwm condition is raised when the FIFO holds more than RXCNT
+     entries.*/
+  u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(sio_rxwm(siop) - 1U);
+
+  siop->rxlook   = UART_RXDATA_EMPTY;
+  siop->rxactive = false;
+  siop->txend    = false;
+
+  return false;
+}
+
+/**
+ * @brief   Deactivates the SIO peripheral.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ *
+ * @notapi
+ */
+void sio_lld_stop(SIODriver *siop) {
+  fe310_uart_t *u = siop->uart;
+
+  if (siop->state == SIO_READY) {
+    u->IE = 0;
+    u->TXCTRL = 0;
+    u->RXCTRL = 0;
+
+    if (false) {
+    }
+#if FE310_SIO_USE_UART0 == TRUE
+    else if (siop == &SIOD0) {
+      plicDisableInterrupt(FE310_UART0_NUMBER);
+    }
+#endif
+#if FE310_SIO_USE_UART1 == TRUE
+    else if (siop == &SIOD1) {
+      plicDisableInterrupt(FE310_UART1_NUMBER);
+    }
+#endif
+    else {
+      osalDbgAssert(false, "invalid SIO instance");
+    }
+  }
+}
+
+/**
+ * @brief   Starts a SIO operation.
+ * @details The RX interrupt is enabled if there is an RX or RX idle
+ *          callback, the TX interrupt is only enabled by writes.
+ *
+ * @param[in] siop      pointer to an @p SIODriver structure
+ *
+ * @notapi
+ */
+void sio_lld_start_operation(SIODriver *siop) {
+  fe310_uart_t *u = siop->uart;
+
+  siop->rxactive = false;
+  siop->txend    = false;
+
+  if (sio_uses_idle(siop))
+    u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(0);
+
+  if ((siop->operation->rx_cb != NULL) ||
+      (siop->operation->rx_idle_cb != NULL)) {
+    u->IE = UART_IE_RXWM;
+  }
+  else {
+    u->IE = 0;
+  }
+}
+
+/**
+ * @brief   Stops an ongoing SIO operation, if any.
+ *
+ * @param[in] siop      pointer to an @p SIODriver structure
+ *
+ * @notapi
+ */
+void sio_lld_stop_operation(SIODriver *siop) {
+  fe310_uart_t *u = siop->uart;
+
+  u->IE = 0;
+  if (chVTIsArmedI(&siop->rxvt))
+    chVTResetI(&siop->rxvt);
+
+  u->TXCTRL = UART_TXCTRL_TXEN | UART_TXCTRL_NSTOP_1 |
+              UART_TXCTRL_TXCNT(sio_txwm(siop));
+  u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(sio_rxwm(siop) - 1U);
+  siop->txend = false;
+}
+
+/**
+ * @brief   Return the pending SIO errors and clears them.
+ * @note    The FE310 UART detects no line errors, this always returns
+ *          @p SIO_NO_ERROR and the RX event callback is never invoked.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              The pending errors.
+ *
+ * @notapi
+ */
+sioflags_t sio_lld_get_and_clear_errors(SIODriver *siop) {
+
+  (void) siop;
+
+  return (sioflags_t)SIO_NO_ERROR;
+}
+
+/**
+ * @brief   Determines the state of the RX FIFO.
+ * @note    The FIFO level cannot be read, a byte is popped and kept
+ *          aside to find out.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              The RX FIFO state.
+ * @retval false        if RX FIFO is not empty.
+ * @retval true         if RX FIFO is empty.
+ *
+ * @notapi
+ */
+bool sio_lld_is_rx_empty(SIODriver *siop) {
+
+  if ((siop->rxlook & UART_RXDATA_EMPTY) == 0U)
+    return false;
+
+  siop->rxlook = siop->uart->RXDATA;
+  return (siop->rxlook & UART_RXDATA_EMPTY) != 0U;
+}
+
+/**
+ * @brief   Returns one frame from the RX FIFO.
+ * @note    If the FIFO is empty then the returned value is unpredictable.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              The frame from RX FIFO.
+ *
+ * @notapi
+ */
+uint_fast16_t sio_lld_get(SIODriver *siop) {
+  uint32_t data = siop->rxlook;
+
+  if ((data & UART_RXDATA_EMPTY) != 0U)
+    data = siop->uart->RXDATA;
+  siop->rxlook = UART_RXDATA_EMPTY;
+
+  return (uint_fast16_t)(data & UART_RXDATA_DATA_MASK);
+}
+
+/**
+ * @brief   Reads data from the RX FIFO.
+ * @details The function is not blocking, it reads frames until the
+ *          FIFO is empty without waiting. Reading enables the RX interrupt
+ *          again if an operation is ongoing.
+ *
+ * @param[in] siop      pointer to an @p SIODriver structure
+ * @param[in] buffer    pointer to the buffer for read frames
+ * @param[in] n         maximum number of frames to be read
+ * @return              The number of frames copied into the buffer.
+ * @retval 0            if the RX FIFO is empty.
+ *
+ * @notapi
+ */
+size_t sio_lld_read(SIODriver *siop, uint8_t *buffer, size_t n) {
+  uint32_t data;
+  size_t rd = 0;
+
+  if ((n > 0U) && ((siop->rxlook & UART_RXDATA_EMPTY) == 0U)) {
+    buffer[rd++] = (uint8_t)siop->rxlook;
+    siop->rxlook = UART_RXDATA_EMPTY;
+  }
+
+  while ((rd < n) && !((data = siop->uart->RXDATA) & UART_RXDATA_EMPTY)) {
+    buffer[rd++] = (uint8_t)data;
+  }
+
+  sio_rearm_rx(siop);
+
+  return rd;
+}
+
+/**
+ * @brief   Writes data into the TX FIFO.
+ * @details The function is not blocking, it writes frames until there
+ *          is space available without waiting.
+ *
+ * @param[in] siop      pointer to an @p SIODriver structure
+ * @param[in] buffer    pointer to the frames to be written
+ * @param[in] n         maximum number of frames to be written
+ * @return              The number of frames copied from the buffer.
+ * @retval 0            if the TX FIFO is full.
+ *
+ * @notapi
+ */
+size_t sio_lld_write(SIODriver *siop, const uint8_t *buffer, size_t n) {
+  fe310_uart_t *u = siop->uart;
+  size_t wr = 0;
+
+  while ((wr < n) && !(u->TXDATA & UART_TXDATA_FULL)) {
+    u->TXDATA = buffer[wr++];
+  }
+
+  if (wr > 0U)
+    sio_rearm_tx(siop);
+
+  return wr;
+}
+
+/**
+ * @brief   Control operation on a serial port.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @param[in] operation control operation code
+ * @param[in,out] arg   operation argument
+ *
+ * @return              The control operation status.
+ * @retval MSG_OK       in case of success.
+ * @retval MSG_TIMEOUT  in case of operation timeout.
+ * @retval MSG_RESET    in case of operation reset.
+ *
+ * @notapi
+ */
+msg_t sio_lld_control(SIODriver *siop, unsigned int operation, void *arg) {
+
+  (void)siop;
+  (void)operation;
+  (void)arg;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Serves an UART interrupt.
+ * @details The interrupt causing a callback is masked before invoking it,
+ *          reading or writing data enables it again. Without an RX
+ *          callback the RX interrupt stays enabled for the idle detection.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ *
+ * @notapi
+ */
+void sio_lld_serve_interrupt(SIODriver *siop) {
+  fe310_uart_t *u = siop->uart;
+  const SIOOperation *op = siop->operation;
+  uint32_t ie = u->IE;
+  uint32_t ip = u->IP;
+
+  if (op == NULL)
+    return;
+
+  if ((ie & UART_IE_RXWM) && (ip & UART_IP_RXWM)) {
+    if (op->rx_cb != NULL) {
+      /* Masked until the RX callback reads the FIFO.*/
+      u->IE &= ~UART_IE_RXWM;
+    }
+    else {
+      /* The data stays in the FIFO, the watermark is moved past the
+         current level so each new frame raises one interrupt and keeps
+         the line active. Masked once the FIFO is full.*/
+      uint32_t cnt = (u->RXCTRL >> UART_RXCTRL_RXCNT_SHIFT) &
+                     UART_RXCTRL_RXCNT_MASK;
+
+      if (cnt < UART_FIFO_SIZE - 1U)
+        u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(cnt + 1U);
+      else
+        u->IE &= ~UART_IE_RXWM;
+    }
+
+    if (sio_uses_idle(siop)) {
+      osalSysLockFromISR();
+      siop->rxactive = true;
+      if (!chVTIsArmedI(&siop->rxvt)) {
+        if (op->rx_cb != NULL)
+          u->RXCTRL = UART_RXCTRL_RXEN |
+                      UART_RXCTRL_RXCNT(sio_rxwm(siop) - 1U);
+        chVTSetI(&siop->rxvt, siop->config->rxidle, sio_rx_idle_cb, siop);
+      }
+      osalSysUnlockFromISR();
+    }
+
+    /* Without an RX callback the data is read from the idle callback.*/
+    if (op->rx_cb != NULL)
+      op->rx_cb(siop);
+  }
+
+  if ((ie & UART_IE_TXWM) && (ip & UART_IP_TXWM)) {
+    u->IE &= ~UART_IE_TXWM;
+
+    if (siop->txend) {
+      /* TX FIFO drained.*/
+      siop->txend = false;
+      u->TXCTRL = (u->TXCTRL & ~UART_TXCTRL_TXCNT(UART_TXCTRL_TXCNT_MASK)) |
+                  UART_TXCTRL_TXCNT(sio_txwm(siop));
+      if (op->tx_end_cb != NULL)
+        op->tx_end_cb(siop);
+    }
+    else {
+      if (op->tx_cb != NULL)
+        op->tx_cb(siop);
+
+      /* Nothing more written, waiting for the FIFO to drain. The last
+         frame is still shifting out when this is reported.*/
+      if (((u->IE & UART_IE_TXWM) == 0U) && (op->tx_end_cb != NULL)) {
+        siop->txend = true;
+        u->TXCTRL = (u->TXCTRL & ~UART_TXCTRL_TXCNT(UART_TXCTRL_TXCNT_MASK)) |
+                    UART_TXCTRL_TXCNT(1);
+        u->IE |= UART_IE_TXWM;
+      }
+    }
+  }
+}
+
+#endif /* HAL_USE_SIO == TRUE */
+
+/** @} */
@@ -0,0 +1,212 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_sio_lld.h
+ * @brief   FE310 SIO subsystem low level driver header.
+ *
+ * @addtogroup SIO
+ * @{
+ */
+
+#ifndef HAL_SIO_LLD_H
+#define HAL_SIO_LLD_H
+
+#include "fe310_uart.h"
+
+#if (HAL_USE_SIO == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    FE310 configuration options
+ * @{
+ */
+/**
+ * @brief   UART0 SIO driver enable switch.
+ * @details If set to @p TRUE the support for UART0 is included.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(FE310_SIO_USE_UART0) || defined(__DOXYGEN__)
+#define FE310_SIO_USE_UART0                 FALSE
+#endif
+
+/**
+ * @brief   UART1 SIO driver enable switch.
+ * @details If set to @p TRUE the support for UART1 is included.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(FE310_SIO_USE_UART1) || defined(__DOXYGEN__)
+#define FE310_SIO_USE_UART1                 FALSE
+#endif
+
+/**
+ * @brief   UART0 interrupt priority level setting.
+ */
+#if !defined(FE310_SIO_UART0_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define FE310_SIO_UART0_IRQ_PRIORITY        1
+#endif
+
+/**
+ * @brief   UART1 interrupt priority level setting.
+ */
+#if !defined(FE310_SIO_UART1_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define FE310_SIO_UART1_IRQ_PRIORITY        1
+#endif
+
+/**
+ * @brief   Maximum bit rate error, in tenths of percent.
+ * @details Bit rates whose rounded divisor is off by more than this are
+ *          rejected by a debug assertion.
+ */
+#if !defined(FE310_SIO_MAX_BAUD_ERROR) || defined(__DOXYGEN__)
+#define FE310_SIO_MAX_BAUD_ERROR            20
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !FE310_SIO_USE_UART0 && !FE310_SIO_USE_UART1
+#error "SIO driver activated but no UART peripheral assigned"
+#endif
+
+#if FE310_SIO_USE_UART0 && (HAL_USE_SERIAL == TRUE) &&                      \
+    defined(FE310_SERIAL_USE_UART0) && FE310_SERIAL_USE_UART0
+#error "UART0 already in use by the serial driver"
+#endif
+
+#if FE310_SIO_USE_UART1 && (HAL_USE_SERIAL == TRUE) &&                      \
+    defined(FE310_SERIAL_USE_UART1) && FE310_SERIAL_USE_UART1
+#error "UART1 already in use by the serial driver"
+#endif
+
+#if FE310_SIO_USE_UART0 &&                                                  \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_SIO_UART0_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to UART0"
+#endif
+
+#if FE310_SIO_USE_UART1 &&                                                  \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_SIO_UART1_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to UART1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level fields of the SIO driver structure.
+ */
+#define sio_lld_driver_fields                                               \
+  /* Pointer to the UART instance.*/                                        \
+  fe310_uart_t              *uart;                                          \
+  /* Byte popped by sio_lld_is_rx_empty(), UART_RXDATA_EMPTY if none.*/     \
+  uint32_t                  rxlook;                                         \
+  /* Data received since the last idle timer expiration.*/                 \
+  bool                      rxactive;                                       \
+  /* Waiting for the TX FIFO to become empty.*/                             \
+  bool                      txend;                                          \
+  /* RX idle timer.*/                                                       \
+  virtual_timer_t           rxvt
+
+/**
+ * @brief   Low level fields of the SIO configuration structure.
+ */
+#define sio_lld_config_fields                                               \
+  /* Bit rate.*/                                                            \
+  uint32_t                  baud;                                           \
+  /* RX watermark, the RX callback is invoked once this many bytes are      \
+     in the FIFO, 1..8, zero means one.*/                                   \
+  uint8_t                   rxwm;                                           \
+  /* TX watermark, the TX callback is invoked when the FIFO holds fewer     \
+     bytes than this, 1..7, zero means one.*/                               \
+  uint8_t                   txwm;                                           \
+  /* RX idle timeout, zero disables the RX idle callback.*/                 \
+  sysinterval_t             rxidle
+
+/**
+ * @brief   Determines the state of the TX FIFO.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @return              The TX FIFO state.
+ * @retval false        if TX FIFO is not full.
+ * @retval true         if TX FIFO is full.
+ *
+ * @notapi
+ */
+#define sio_lld_is_tx_full(siop)                                            \
+  ((bool)(((siop)->uart->TXDATA & UART_TXDATA_FULL) != 0U))
+
+/**
+ * @brief   Pushes one frame into the TX FIFO.
+ * @note    If the FIFO is full then the behavior is unpredictable.
+ *
+ * @param[in] siop      pointer to the @p SIODriver object
+ * @param[in] data      frame to be written
+ *
+ * @notapi
+ */
+#define sio_lld_put(siop, data)                                             \
+  ((siop)->uart->TXDATA = UART_TXDATA_DATA(data))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (FE310_SIO_USE_UART0 == TRUE) && !defined(__DOXYGEN__)
+extern SIODriver SIOD0;
+#endif
+
+#if (FE310_SIO_USE_UART1 == TRUE) && !defined(__DOXYGEN__)
+extern SIODriver SIOD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void sio_lld_init(void);
+  bool sio_lld_start(SIODriver *siop);
+  void sio_lld_stop(SIODriver *siop);
+  void sio_lld_start_operation(SIODriver *siop);
+  void sio_lld_stop_operation(SIODriver *siop);
+  sioflags_t sio_lld_get_and_clear_errors(SIODriver *siop);
+  bool sio_lld_is_rx_empty(SIODriver *siop);
+  uint_fast16_t sio_lld_get(SIODriver *siop);
+  size_t sio_lld_read(SIODriver *siop, uint8_t *buffer, size_t n);
+  size_t sio_lld_write(SIODriver *siop, const uint8_t *buffer, size_t n);
+  msg_t sio_lld_control(SIODriver *siop, unsigned int operation, void *arg);
+  void sio_lld_serve_interrupt(SIODriver *siop);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_SIO == TRUE */
+
+#endif /* HAL_SIO_LLD_H */
+
+/** @} */
@@ -0,0 +1,475 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_spi_lld.c
+ * @brief   FE310 SPI subsystem low level driver source.
+ * @details The controller is always operated full duplex, every frame
+ *          loaded in the TX FIFO returns one frame in the RX FIFO. At most
+ *          @p SPI_FIFO_SIZE frames are in flight so the RX FIFO cannot
+ *          overflow, the RX watermark interrupt drains it and loads the
+ *          next burst.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#include "hal.h"
+
+#if (HAL_USE_SPI == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Frame sent when there is no transmit buffer.
+ */
+#define SPI_DUMMY_FRAME             0xFFU
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief SPI1 driver identifier.*/
+#if (FE310_SPI_USE_SPI1 == TRUE) || defined(__DOXYGEN__)
+SPIDriver SPID1;
+#endif
+
+/** @brief SPI2 driver identifier.*/
+#if (FE310_SPI_USE_SPI2 == TRUE) || defined(__DOXYGEN__)
+SPIDriver SPID2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Reads the frames available in the RX FIFO.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ */
+static void spi_drain(SPIDriver *spip) {
+  fe310_spi_t *s = spip->spi;
+
+  while (spip->rxn > 0U) {
+    uint32_t d = s->RXDATA;
+
+    if ((d & SPI_RXDATA_EMPTY) != 0U) {
+      break;
+    }
+    if (spip->rxbuf != NULL) {
+      *spip->rxbuf++ = (uint8_t)d;
+    }
+    spip->rxn--;
+  }
+}
+
+/**
+ * @brief   Loads the TX FIFO.
+ * @details Frames are loaded until @p SPI_FIFO_SIZE frames are in flight.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The number of frames in flight.
+ */
+static size_t spi_fill(SPIDriver *spip) {
+  fe310_spi_t *s = spip->spi;
+  size_t inflight = spip->rxn - spip->txn;
+
+  while ((spip->txn > 0U) && (inflight < SPI_FIFO_SIZE)) {
+    if (spip->txbuf != NULL) {
+      s->TXDATA = *spip->txbuf++;
+    }
+    else {
+      s->TXDATA = SPI_DUMMY_FRAME;
+    }
+    spip->txn--;
+    inflight++;
+  }
+
+  return inflight;
+}
+
+/**
+ * @brief   Loads a burst and programs the RX watermark.
+ * @details The interrupt is raised with @p FE310_SPI_RX_SLACK frames still
+ *          in flight, or after the last frame of the transfer.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ */
+static void spi_burst(SPIDriver *spip) {
+  size_t inflight = spi_fill(spip);
+
+  if ((spip->txn == 0U) || (inflight <= (size_t)FE310_SPI_RX_SLACK)) {
+    spip->spi->RXMARK = SPI_MARK(inflight - 1U);
+  }
+  else {
+    spip->spi->RXMARK = SPI_MARK(inflight - 1U - FE310_SPI_RX_SLACK);
+  }
+}
+
+/**
+ * @brief   Starts a transfer.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of frames
+ * @param[in] txbuf     transmit buffer or @p NULL
+ * @param[in] rxbuf     receive buffer or @p NULL
+ */
+static void spi_start_xfer(SPIDriver *spip, size_t n,
+                           const void *txbuf, void *rxbuf) {
+
+  osalDbgCheck(n > 0U);
+
+  spip->txbuf = (const uint8_t *)txbuf;
+  spip->rxbuf = (uint8_t *)rxbuf;
+  spip->txn   = n;
+  spip->rxn   = n;
+
+  spi_burst(spip);
+  spip->spi->IE = SPI_IE_RXWM;
+}
+
+/**
+ * @brief   Common IRQ handler.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ */
+static void spi_serve_interrupt(SPIDriver *spip) {
+
+  spi_drain(spip);
+  if (spip->rxn > 0U) {
+    spi_burst(spip);
+  }
+  else {
+    spip->spi->IE = 0U;
+    _spi_isr_code(spip);
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+#if FE310_SPI_USE_SPI1 || defined(__DOXYGEN__)
+#if !defined(FE310_SPI1_HANDLER)
+#error "FE310_SPI1_HANDLER not defined"
+#endif
+/**
+ * @brief   SPI1 interrupt handler.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(FE310_SPI1_HANDLER) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  spi_serve_interrupt(&SPID1);
+
+  OSAL_IRQ_EPILOGUE();
+}
+#endif
+
+#if FE310_SPI_USE_SPI2 || defined(__DOXYGEN__)
+#if !defined(FE310_SPI2_HANDLER)
+#error "FE310_SPI2_HANDLER not defined"
+#endif
+/**
+ * @brief   SPI2 interrupt handler.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(FE310_SPI2_HANDLER) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  spi_serve_interrupt(&SPID2);
+
+  OSAL_IRQ_EPILOGUE();
+}
+#endif
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SPI driver initialization.
+ *
+ * @notapi
+ */
+void spi_lld_init(void) {
+
+#if FE310_SPI_USE_SPI1 == TRUE
+  spiObjectInit(&SPID1);
+  SPID1.spi = SPI1;
+#endif
+
+#if FE310_SPI_USE_SPI2 == TRUE
+  spiObjectInit(&SPID2);
+  SPID2.spi = SPI2;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_start(SPIDriver *spip) {
+  fe310_spi_t *s = spip->spi;
+  const SPIConfig *config = spip->config;
+
+  osalDbgCheck(config->sckdiv <= SPI_SCKDIV_DIV_MASK);
+
+  if (spip->state == SPI_STOP) {
+    if (false) {
+    }
+#if FE310_SPI_USE_SPI1 == TRUE
+    else if (spip == &SPID1) {
+      plicEnableInterrupt(FE310_SPI1_NUMBER, FE310_SPI_SPI1_IRQ_PRIORITY);
+    }
+#endif
+#if FE310_SPI_USE_SPI2 == TRUE
+    else if (spip == &SPID2) {
+      plicEnableInterrupt(FE310_SPI2_NUMBER, FE310_SPI_SPI2_IRQ_PRIORITY);
+    }
+#endif
+    else {
+      osalDbgAssert(false, "invalid SPI instance");
+    }
+  }
+
+  s->IE      = 0;
+  s->CSMODE  = SPI_CSMODE_OFF;
+  s->SCKDIV  = SPI_SCKDIV_DIV(config->sckdiv);
+  s->SCKMODE = config->sckmode & (SPI_SCKMODE_PHA | SPI_SCKMODE_POL);
+  s->CSID    = config->csid;
+  s->FMT     = SPI_FMT_PROTO_SINGLE | SPI_FMT_DIR_RX | SPI_FMT_LEN(8) |
+               (config->endian & SPI_FMT_ENDIAN_LSB);
+  s->DELAY0  = config->delay0 != 0U ? config->delay0 :
+               SPI_DELAY0_CSSCK(1) | SPI_DELAY0_SCKCS(1);
+  s->DELAY1  = config->delay1 != 0U ? config->delay1 :
+               SPI_DELAY1_INTERCS(1);
+  s->TXMARK = 0;
+
+  /* Frames left by a previous configuration.*/
+  while ((s->RXDATA & SPI_RXDATA_EMPTY) == 0U) {
+  }
+}
+
+/**
+ * @brief   Deactivates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_stop(SPIDriver *spip) {
+  fe310_spi_t *s = spip->spi;
+
+  if (spip->state == SPI_READY) {
+    s->IE     = 0;
+    s->CSMODE = SPI_CSMODE_OFF;
+
+    if (false) {
+    }
+#if FE310_SPI_USE_SPI1 == TRUE
+    else if (spip == &SPID1) {
+      plicDisableInterrupt(FE310_SPI1_NUMBER);
+    }
+#endif
+#if FE310_SPI_USE_SPI2 == TRUE
+    else if (spip == &SPID2) {
+      plicDisableInterrupt(FE310_SPI2_NUMBER);
+    }
+#endif
+    else {
+      osalDbgAssert(false, "invalid SPI instance");
+    }
+  }
+}
+
+#if (SPI_SELECT_MODE == SPI_SELECT_MODE_LLD) || defined(__DOXYGEN__)
+/**
+ * @brief   Asserts the slave select signal and prepares for transfers.
+ * @details The hardware chip select is held for the whole selection,
+ *          or toggled around each frame if @p csauto is set.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_select(SPIDriver *spip) {
+
+  spip->spi->CSMODE = spip->config->csauto ? SPI_CSMODE_AUTO :
+                                             SPI_CSMODE_HOLD;
+}
+
+/**
+ * @brief   Deasserts the slave select signal.
+ * @details The previously selected peripheral is unselected.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_unselect(SPIDriver *spip) {
+
+  spip->spi->CSMODE = SPI_CSMODE_OFF;
+}
+#endif
+
+/**
+ * @brief   Ignores data on the SPI bus.
+ * @details This asynchronous function starts the transmission of a series of
+ *          idle words on the SPI bus and ignores the received data.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be ignored
+ *
+ * @notapi
+ */
+void spi_lld_ignore(SPIDriver *spip, size_t n) {
+
+  spi_start_xfer(spip, n, NULL, NULL);
+}
+
+/**
+ * @brief   Exchanges data on the SPI bus.
+ * @details This asynchronous function starts a simultaneous transmit/receive
+ *          operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_exchange(SPIDriver *spip, size_t n,
+                      const void *txbuf, void *rxbuf) {
+
+  spi_start_xfer(spip, n, txbuf, rxbuf);
+}
+
+/**
+ * @brief   Sends data over the SPI bus.
+ * @details This asynchronous function starts a transmit operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
+
+  spi_start_xfer(spip, n, txbuf, NULL);
+}
+
+/**
+ * @brief   Receives data from the SPI bus.
+ * @details This asynchronous function starts a receive operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
+
+  spi_start_xfer(spip, n, NULL, rxbuf);
+}
+
+/**
+ * @brief   Exchanges one frame using a polled wait.
+ * @details This synchronous function exchanges one frame using a polled
+ *          synchronization method. This function is useful when exchanging
+ *          small amount of data on high speed channels, usually in this
+ *          situation is much more efficient just wait for completion using
+ *          polling than suspending the thread waiting for an interrupt.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] frame     the data frame to send over the SPI bus
+ * @return              The received data frame from the SPI bus.
+ *
+ * @notapi
+ */
+uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame) {
+  fe310_spi_t *s = spip->spi;
+  uint32_t d;
+
+  while ((s->TXDATA & SPI_TXDATA_FULL) != 0U) {
+  }
+  s->TXDATA = SPI_TXDATA_DATA(frame);
+  do {
+    d = s->RXDATA;
+  } while ((d & SPI_RXDATA_EMPTY) != 0U);
+
+  return (uint16_t)SPI_RXDATA_DATA(d);
+}
+
+/**
+ * @brief   Exchanges a buffer using a polled wait.
+ * @details Short exchanges, like a command and its reply, complete faster
+ *          by spinning on the FIFOs than by waiting for the interrupt and
+ *          rescheduling. The FIFOs are loaded in bursts as by the
+ *          interrupt driven transfers.
+ * @pre     The driver must be in the @p SPI_READY state, the peripheral is
+ *          usually selected.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of frames to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer, @p NULL sends
+ *                      ones
+ * @param[out] rxbuf    the pointer to the receive buffer, @p NULL discards
+ *                      the received frames
+ *
+ * @api
+ */
+void fe310SpiPolledExchange(SPIDriver *spip, size_t n,
+                            const void *txbuf, void *rxbuf) {
+
+  osalDbgCheck((spip != NULL) && (n > 0U));
+  osalDbgAssert(spip->state == SPI_READY, "not ready");
+
+  spip->txbuf = (const uint8_t *)txbuf;
+  spip->rxbuf = (uint8_t *)rxbuf;
+  spip->txn   = n;
+  spip->rxn   = n;
+
+  do {
+    (void) spi_fill(spip);
+    spi_drain(spip);
+  } while (spip->rxn > 0U);
+}
+
+#endif /* HAL_USE_SPI == TRUE */
+
+/** @} */
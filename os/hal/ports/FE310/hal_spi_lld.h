@@ -0,0 +1,194 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_spi_lld.h
+ * @brief   FE310 SPI subsystem low level driver header.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#ifndef HAL_SPI_LLD_H
+#define HAL_SPI_LLD_H
+
+#include "fe310_spi.h"
+
+#if (HAL_USE_SPI == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Circular mode support flag.
+ */
+#define SPI_SUPPORTS_CIRCULAR               FALSE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    FE310 configuration options
+ * @{
+ */
+/**
+ * @brief   SPI driver on SPI1 enable switch.
+ * @details If set to @p TRUE the support for SPI1 is included.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(FE310_SPI_USE_SPI1) || defined(__DOXYGEN__)
+#define FE310_SPI_USE_SPI1                  FALSE
+#endif
+
+/**
+ * @brief   SPI driver on SPI2 enable switch.
+ * @details If set to @p TRUE the support for SPI2 is included.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(FE310_SPI_USE_SPI2) || defined(__DOXYGEN__)
+#define FE310_SPI_USE_SPI2                  FALSE
+#endif
+
+/**
+ * @brief   SPI1 interrupt priority level setting.
+ */
+#if !defined(FE310_SPI_SPI1_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define FE310_SPI_SPI1_IRQ_PRIORITY         1
+#endif
+
+/**
+ * @brief   SPI2 interrupt priority level setting.
+ */
+#if !defined(FE310_SPI_SPI2_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define FE310_SPI_SPI2_IRQ_PRIORITY         1
+#endif
+
+/**
+ * @brief   Frames still in flight when the RX interrupt is raised.
+ * @details The FIFO is refilled while these frames are being shifted,
+ *          so SCK keeps running across the interrupt latency.
+ */
+#if !defined(FE310_SPI_RX_SLACK) || defined(__DOXYGEN__)
+#define FE310_SPI_RX_SLACK                  2
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !FE310_SPI_USE_SPI1 && !FE310_SPI_USE_SPI2
+#error "SPI driver activated but no SPI peripheral assigned"
+#endif
+
+#if FE310_SPI_USE_SPI1 &&                                                   \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_SPI_SPI1_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to SPI1"
+#endif
+
+#if FE310_SPI_USE_SPI2 &&                                                   \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_SPI_SPI2_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to SPI2"
+#endif
+
+#if (FE310_SPI_RX_SLACK < 0) || (FE310_SPI_RX_SLACK >= SPI_FIFO_SIZE)
+#error "FE310_SPI_RX_SLACK out of range"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level fields of the SPI driver structure.
+ */
+#define spi_lld_driver_fields                                               \
+  /* Pointer to the SPI registers block.*/                                  \
+  fe310_spi_t               *spi;                                           \
+  /* Transmit pointer, NULL sends ones.*/                                   \
+  const uint8_t             *txbuf;                                         \
+  /* Receive pointer, NULL discards.*/                                      \
+  uint8_t                   *rxbuf;                                         \
+  /* Frames left to be loaded in the TX FIFO.*/                             \
+  size_t                    txn;                                            \
+  /* Frames left to be read from the RX FIFO.*/                             \
+  size_t                    rxn
+
+/**
+ * @brief   Low level fields of the SPI configuration structure.
+ */
+#define spi_lld_config_fields                                               \
+  /* SCKDIV register, see SPI_SCKDIV_FOR().*/                               \
+  uint32_t                  sckdiv;                                         \
+  /* SCKMODE register, clock polarity and phase.*/                          \
+  uint32_t                  sckmode;                                        \
+  /* Hardware chip select index.*/                                          \
+  uint32_t                  csid;                                           \
+  /* Hardware chip select toggled around each frame instead of being held   \
+     for the whole selection, SPI_SELECT_MODE_LLD only.*/                   \
+  bool                      csauto;                                         \
+  /* FMT register endianness, SPI_FMT_ENDIAN_MSB or SPI_FMT_ENDIAN_LSB.*/    \
+  uint32_t                  endian;                                         \
+  /* DELAY0 and DELAY1 registers, zero selects the reset values so that     \
+     the delays of a previous configuration are not kept.*/                 \
+  uint32_t                  delay0;                                         \
+  uint32_t                  delay1
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (FE310_SPI_USE_SPI1 == TRUE) && !defined(__DOXYGEN__)
+extern SPIDriver SPID1;
+#endif
+
+#if (FE310_SPI_USE_SPI2 == TRUE) && !defined(__DOXYGEN__)
+extern SPIDriver SPID2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void spi_lld_init(void);
+  void spi_lld_start(SPIDriver *spip);
+  void spi_lld_stop(SPIDriver *spip);
+#if (SPI_SELECT_MODE == SPI_SELECT_MODE_LLD) || defined(__DOXYGEN__)
+  void spi_lld_select(SPIDriver *spip);
+  void spi_lld_unselect(SPIDriver *spip);
+#endif
+  void spi_lld_ignore(SPIDriver *spip, size_t n);
+  void spi_lld_exchange(SPIDriver *spip, size_t n,
+                        const void *txbuf, void *rxbuf);
+  void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf);
+  void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf);
+  uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame);
+  void fe310SpiPolledExchange(SPIDriver *spip, size_t n,
+                              const void *txbuf, void *rxbuf);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_SPI == TRUE */
+
+#endif /* HAL_SPI_LLD_H */
+
+/** @} */
@@ -0,0 +1,462 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_uart_lld.c
+ * @brief   FE310 UART subsystem low level driver source.
+ *
+ * @addtogroup UART
+ * @{
+ */
+
+#include "hal.h"
+
+#if (HAL_USE_UART == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @name    Transmission phases
+ * @{
+ */
+#define UART_TXPHASE_IDLE           0U
+#define UART_TXPHASE_LOADING        1U
+#define UART_TXPHASE_DRAINING       2U
+/** @} */
+
+/**
+ * @brief   TX FIFO level below which the FIFO is refilled.
+ */
+#define UART_TX_REFILL_LEVEL        (UART_FIFO_SIZE / 2U)
+
+/**
+ * @brief   Bits in a frame, start, data and stop bits.
+ */
+#define UART_FRAME_BITS             10U
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief UART0 UART driver identifier.*/
+#if (FE310_UART_USE_UART0 == TRUE) || defined(__DOXYGEN__)
+UARTDriver UARTD0;
+#endif
+
+/** @brief UART1 UART driver identifier.*/
+#if (FE310_UART_USE_UART1 == TRUE) || defined(__DOXYGEN__)
+UARTDriver UARTD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts a number of bit times into an interval.
+ * @details The result is rounded up, timeouts are never shorter than
+ *          requested.
+ *
+ * @param[in] bits      number of bit times
+ * @param[in] speed     bit rate
+ * @return              The interval.
+ */
+static sysinterval_t uart_bits2i(uint32_t bits, uint32_t speed) {
+  uint64_t us = (((uint64_t)bits * 1000000U) + speed - 1U) / speed;
+
+  return TIME_US2I((uint32_t)us);
+}
+
+/**
+ * @brief   Physical end of transmission timer callback.
+ * @details Started when the TX FIFO became empty, it expires after the
+ *          last frame has been shifted out.
+ *
+ * @param[in] p         pointer to the @p UARTDriver object
+ */
+static void uart_txend_cb(void *p) {
+  UARTDriver *uartp = (UARTDriver *)p;
+
+  _uart_tx2_isr_code(uartp);
+}
+
+/**
+ * @brief   Receiver timeout timer callback.
+ * @details The timer is not restarted on each frame, the time of the last
+ *          RX interrupt is checked instead and the timer restarted for the
+ *          part of the gap still missing.
+ *
+ * @param[in] p         pointer to the @p UARTDriver object
+ */
+static void uart_rxgap_cb(void *p) {
+  UARTDriver *uartp = (UARTDriver *)p;
+  sysinterval_t elapsed;
+
+  osalSysLockFromISR();
+  elapsed = osalTimeDiffX(uartp->rxlast, osalOsGetSystemTimeX());
+  if (elapsed < uartp->rxgap) {
+    chVTSetI(&uartp->rxvt, uartp->rxgap - elapsed, uart_rxgap_cb, uartp);
+    osalSysUnlockFromISR();
+    return;
+  }
+  osalSysUnlockFromISR();
+
+  _uart_timeout_isr_code(uartp);
+}
+
+/**
+ * @brief   Dispatches a received frame.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] c         received frame
+ */
+static void uart_rx_frame(UARTDriver *uartp, uint8_t c) {
+
+  if (uartp->rxstate != UART_RX_ACTIVE) {
+    if (uartp->config->rxchar_cb != NULL)
+      uartp->config->rxchar_cb(uartp, c);
+    return;
+  }
+
+  *uartp->rxbuf++ = c;
+  uartp->rxn--;
+
+  if ((uartp->config->match_cb != NULL) && (c == uartp->config->matchchar)) {
+    uartp->config->match_cb(uartp, c);
+
+    /* The callback ended the frame.*/
+    if (uartp->rxstate != UART_RX_ACTIVE)
+      return;
+  }
+
+  if (uartp->rxn == 0U) {
+    _uart_rx_complete_isr_code(uartp);
+  }
+}
+
+/**
+ * @brief   Common IRQ handler.
+ * @details The RX FIFO is drained with the same loop used by the serial
+ *          driver, frames go to the receive buffer while a reception is
+ *          active and to the @p rxchar_cb callback otherwise.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+static void serve_interrupt(UARTDriver *uartp) {
+  fe310_uart_t *u = uartp->uart;
+  uint32_t ie = u->IE;
+  uint32_t ip = u->IP;
+
+  /* Data available.*/
+  if ((ie & UART_IE_RXWM) && (ip & UART_IP_RXWM)) {
+    uint32_t data;
+
+    while (!((data = u->RXDATA) & UART_RXDATA_EMPTY)) {
+      uart_rx_frame(uartp, (uint8_t) data);
+    }
+
+    if (uartp->rxgap > (sysinterval_t)0) {
+      osalSysLockFromISR();
+      uartp->rxlast = osalOsGetSystemTimeX();
+      if (!chVTIsArmedI(&uartp->rxvt))
+        chVTSetI(&uartp->rxvt, uartp->rxgap, uart_rxgap_cb, uartp);
+      osalSysUnlockFromISR();
+    }
+  }
+
+  /* Transmission FIFO below the watermark.*/
+  if ((ie & UART_IE_TXWM) && (ip & UART_IP_TXWM)) {
+    if (uartp->txphase == UART_TXPHASE_LOADING) {
+      while ((uartp->txn > 0U) && !(u->TXDATA & UART_TXDATA_FULL)) {
+        u->TXDATA = *uartp->txbuf++;
+        uartp->txn--;
+      }
+
+      if (uartp->txn == 0U) {
+        /* Buffer loaded, now waiting for the FIFO to be empty.*/
+        uartp->txphase = UART_TXPHASE_DRAINING;
+        u->TXCTRL = UART_TXCTRL_TXEN | UART_TXCTRL_NSTOP_1 |
+                    UART_TXCTRL_TXCNT(1);
+        _uart_tx1_isr_code(uartp);
+      }
+    }
+    else if (uartp->txphase == UART_TXPHASE_DRAINING) {
+      /* FIFO empty, the last frame is still being shifted out.*/
+      uartp->txphase = UART_TXPHASE_IDLE;
+      osalSysLockFromISR();
+      u->IE &= ~UART_IE_TXWM;
+      chVTSetI(&uartp->txvt, uartp->chartime, uart_txend_cb, uartp);
+      osalSysUnlockFromISR();
+    }
+    else {
+      osalSysLockFromISR();
+      u->IE &= ~UART_IE_TXWM;
+      osalSysUnlockFromISR();
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+#if FE310_UART_USE_UART0 || defined(__DOXYGEN__)
+#if !defined(FE310_UART0_HANDLER)
+#error "FE310_UART0_HANDLER not defined"
+#endif
+/**
+ * @brief   UART0 interrupt handler.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(FE310_UART0_HANDLER) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  serve_interrupt(&UARTD0);
+
+  OSAL_IRQ_EPILOGUE();
+}
+#endif
+
+#if FE310_UART_USE_UART1 || defined(__DOXYGEN__)
+#if !defined(FE310_UART1_HANDLER)
+#error "FE310_UART1_HANDLER not defined"
+#endif
+/**
+ * @brief   UART1 interrupt handler.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(FE310_UART1_HANDLER) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  serve_interrupt(&UARTD1);
+
+  OSAL_IRQ_EPILOGUE();
+}
+#endif
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level UART driver initialization.
+ *
+ * @notapi
+ */
+void uart_lld_init(void) {
+
+#if FE310_UART_USE_UART0 == TRUE
+  uartObjectInit(&UARTD0);
+  UARTD0.uart = UART0;
+  chVTObjectInit(&UARTD0.rxvt);
+  chVTObjectInit(&UARTD0.txvt);
+#endif
+
+#if FE310_UART_USE_UART1 == TRUE
+  uartObjectInit(&UARTD1);
+  UARTD1.uart = UART1;
+  chVTObjectInit(&UARTD1.rxvt);
+  chVTObjectInit(&UARTD1.txvt);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the UART peripheral.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_start(UARTDriver *uartp) {
+  fe310_uart_t *u = uartp->uart;
+  const UARTConfig *config = uartp->config;
+
+  osalDbgCheck(config->speed > 0U);
+
+  if (uartp->state == UART_STOP) {
+    if (false) {
+    }
+#if FE310_UART_USE_UART0 == TRUE
+    else if (uartp == &UARTD0) {
+      plicEnableInterrupt(FE310_UART0_NUMBER, FE310_UART_UART0_IRQ_PRIORITY);
+    }
+#endif
+#if FE310_UART_USE_UART1 == TRUE
+    else if (uartp == &UARTD1) {
+      plicEnableInterrupt(FE310_UART1_NUMBER, FE310_UART_UART1_IRQ_PRIORITY);
+    }
+#endif
+    else {
+      osalDbgAssert(false, "invalid UART instance");
+    }
+  }
+
+  uartp->txphase  = UART_TXPHASE_IDLE;
+  uartp->chartime = uart_bits2i(UART_FRAME_BITS, config->speed);
+  uartp->rxgap    = config->timeout > 0U ?
+                    uart_bits2i(config->timeout, config->speed) :
+                    (sysinterval_t)0;
+
+  u->IE = 0;
+  u->DIV = UART_DIV_DIV(UART_DIV_ROUND(FE310_CORECLK, config->speed));
+  u->TXCTRL = UART_TXCTRL_TXEN | UART_TXCTRL_NSTOP_1 |
+              UART_TXCTRL_TXCNT(UART_TX_REFILL_LEVEL);
+
+  /* Each frame raises an interrupt, frames are also delivered outside
+     of receptions.*/
+  u->RXCTRL = UART_RXCTRL_RXEN | UART_RXCTRL_RXCNT(0);
+  u->IE = UART_IE_RXWM;
+}
+
+/**
+ * @brief   Deactivates the UART peripheral.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_stop(UARTDriver *uartp) {
+  fe310_uart_t *u = uartp->uart;
+
+  if (uartp->state == UART_READY) {
+    u->IE = 0;
+    u->TXCTRL = 0;
+    u->RXCTRL = 0;
+
+    if (chVTIsArmedI(&uartp->rxvt))
+      chVTResetI(&uartp->rxvt);
+    if (chVTIsArmedI(&uartp->txvt))
+      chVTResetI(&uartp->txvt);
+
+    if (false) {
+    }
+#if FE310_UART_USE_UART0 == TRUE
+    else if (uartp == &UARTD0) {
+      plicDisableInterrupt(FE310_UART0_NUMBER);
+    }
+#endif
+#if FE310_UART_USE_UART1 == TRUE
+    else if (uartp == &UARTD1) {
+      plicDisableInterrupt(FE310_UART1_NUMBER);
+    }
+#endif
+    else {
+      osalDbgAssert(false, "invalid UART instance");
+    }
+  }
+}
+
+/**
+ * @brief   Starts a transmission on the UART peripheral.
+ * @note    The buffers are organized as uint8_t arrays for data sizes below
+ *          or equal to 8 bits else it is organized as uint16_t arrays.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_send(UARTDriver *uartp, size_t n, const void *txbuf) {
+  fe310_uart_t *u = uartp->uart;
+
+  /* A pending physical end belongs to the previous transmission.*/
+  if (chVTIsArmedI(&uartp->txvt))
+    chVTResetI(&uartp->txvt);
+
+  uartp->txbuf   = (const uint8_t *)txbuf;
+  uartp->txn     = n;
+  uartp->txphase = UART_TXPHASE_LOADING;
+
+  u->TXCTRL = UART_TXCTRL_TXEN | UART_TXCTRL_NSTOP_1 |
+              UART_TXCTRL_TXCNT(UART_TX_REFILL_LEVEL);
+  u->IE |= UART_IE_TXWM;
+}
+
+/**
+ * @brief   Stops any ongoing transmission.
+ * @note    Stopping a transmission also suppresses the transmission
+ *          callbacks.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @return              The number of data frames not transmitted by the
+ *                      stopped transmit operation.
+ *
+ * @notapi
+ */
+size_t uart_lld_stop_send(UARTDriver *uartp) {
+  fe310_uart_t *u = uartp->uart;
+
+  u->IE &= ~UART_IE_TXWM;
+  if (chVTIsArmedI(&uartp->txvt))
+    chVTResetI(&uartp->txvt);
+  uartp->txphase = UART_TXPHASE_IDLE;
+
+  return uartp->txn;
+}
+
+/**
+ * @brief   Starts a receive operation on the UART peripheral.
+ * @note    The buffers are organized as uint8_t arrays for data sizes below
+ *          or equal to 8 bits else it is organized as uint16_t arrays.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames to send
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf) {
+
+  /* Frames are moved by the RX interrupt, always enabled.*/
+  uartp->rxbuf = (uint8_t *)rxbuf;
+  uartp->rxn   = n;
+}
+
+/**
+ * @brief   Stops any ongoing receive operation.
+ * @note    Stopping a receive operation also suppresses the receive
+ *          callbacks.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @return              The number of data frames not received by the
+ *                      stopped receive operation.
+ *
+ * @notapi
+ */
+size_t uart_lld_stop_receive(UARTDriver *uartp) {
+  size_t n = uartp->rxn;
+
+  uartp->rxn = 0U;
+
+  return n;
+}
+
+#endif /* HAL_USE_UART == TRUE */
+
+/** @} */
@@ -0,0 +1,322 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_uart_lld.h
+ * @brief   FE310 UART subsystem low level driver header.
+ *
+ * @addtogroup UART
+ * @{
+ */
+
+#ifndef HAL_UART_LLD_H
+#define HAL_UART_LLD_H
+
+#include "fe310_uart.h"
+
+#if (HAL_USE_UART == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    FE310 configuration options
+ * @{
+ */
+/**
+ * @brief   UART driver on UART0 enable switch.
+ * @details If set to @p TRUE the support for UART0 is included.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(FE310_UART_USE_UART0) || defined(__DOXYGEN__)
+#define FE310_UART_USE_UART0                FALSE
+#endif
+
+/**
+ * @brief   UART driver on UART1 enable switch.
+ * @details If set to @p TRUE the support for UART1 is included.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(FE310_UART_USE_UART1) || defined(__DOXYGEN__)
+#define FE310_UART_USE_UART1                FALSE
+#endif
+
+/**
+ * @brief   UART0 interrupt priority level setting.
+ */
+#if !defined(FE310_UART_UART0_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define FE310_UART_UART0_IRQ_PRIORITY       1
+#endif
+
+/**
+ * @brief   UART1 interrupt priority level setting.
+ */
+#if !defined(FE310_UART_UART1_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define FE310_UART_UART1_IRQ_PRIORITY       1
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !FE310_UART_USE_UART0 && !FE310_UART_USE_UART1
+#error "UART driver activated but no UART peripheral assigned"
+#endif
+
+#if FE310_UART_USE_UART0 &&                                                 \
+    (((HAL_USE_SERIAL == TRUE) &&                                           \
+      defined(FE310_SERIAL_USE_UART0) && FE310_SERIAL_USE_UART0) ||         \
+     ((HAL_USE_SIO == TRUE) &&                                              \
+      defined(FE310_SIO_USE_UART0) && FE310_SIO_USE_UART0))
+#error "UART0 already in use by another driver"
+#endif
+
+#if FE310_UART_USE_UART1 &&                                                 \
+    (((HAL_USE_SERIAL == TRUE) &&                                           \
+      defined(FE310_SERIAL_USE_UART1) && FE310_SERIAL_USE_UART1) ||         \
+     ((HAL_USE_SIO == TRUE) &&                                              \
+      defined(FE310_SIO_USE_UART1) && FE310_SIO_USE_UART1))
+#error "UART1 already in use by another driver"
+#endif
+
+#if FE310_UART_USE_UART0 &&                                                 \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_UART_UART0_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to UART0"
+#endif
+
+#if FE310_UART_USE_UART1 &&                                                 \
+    !OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(FE310_UART_UART1_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to UART1"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   UART driver condition flags type.
+ */
+typedef uint32_t uartflags_t;
+
+/**
+ * @brief   Type of structure representing an UART driver.
+ */
+typedef struct hal_uart_driver UARTDriver;
+
+/**
+ * @brief   Generic UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+typedef void (*uartcb_t)(UARTDriver *uartp);
+
+/**
+ * @brief   Character received UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object triggering the
+ *                      callback
+ * @param[in] c         received character
+ */
+typedef void (*uartccb_t)(UARTDriver *uartp, uint16_t c);
+
+/**
+ * @brief   Receive error UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object triggering the
+ *                      callback
+ * @param[in] e         receive error mask
+ */
+typedef void (*uartecb_t)(UARTDriver *uartp, uartflags_t e);
+
+/**
+ * @brief   Driver configuration structure.
+ * @note    It could be empty on some architectures.
+ */
+typedef struct hal_uart_config {
+  /**
+   * @brief End of transmission buffer callback.
+   */
+  uartcb_t                  txend1_cb;
+  /**
+   * @brief Physical end of transmission callback.
+   */
+  uartcb_t                  txend2_cb;
+  /**
+   * @brief Receive buffer filled callback.
+   */
+  uartcb_t                  rxend_cb;
+  /**
+   * @brief Character received while out of the @p UART_RECEIVE state.
+   */
+  uartccb_t                 rxchar_cb;
+  /**
+   * @brief Receive error callback.
+   * @note  The FE310 UART detects no line errors, it is never invoked.
+   */
+  uartecb_t                 rxerr_cb;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Receiver timeout callback.
+   * @details Invoked when no character has been received for
+   *          @p timeout bit times.
+   */
+  uartcb_t                  timeout_cb;
+  /**
+   * @brief Receiver timeout in bit times, zero disables it.
+   */
+  uint32_t                  timeout;
+  /**
+   * @brief Bit rate.
+   */
+  uint32_t                  speed;
+  /**
+   * @brief Character match callback.
+   * @details Invoked during a reception, after @p matchchar has been
+   *          stored in the buffer. It can end the frame by stopping the
+   *          reception.
+   */
+  uartccb_t                 match_cb;
+  /**
+   * @brief Character matched by @p match_cb.
+   */
+  uint8_t                   matchchar;
+} UARTConfig;
+
+/**
+ * @brief   Structure representing an UART driver.
+ */
+struct hal_uart_driver {
+  /**
+   * @brief Driver state.
+   */
+  uartstate_t               state;
+  /**
+   * @brief Transmitter state.
+   */
+  uarttxstate_t             txstate;
+  /**
+   * @brief Receiver state.
+   */
+  uartrxstate_t             rxstate;
+  /**
+   * @brief Current configuration data.
+   */
+  const UARTConfig          *config;
+#if (UART_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Synchronization flag for transmit operations.
+   */
+  bool                      early;
+  /**
+   * @brief   Waiting thread on RX.
+   */
+  thread_reference_t        threadrx;
+  /**
+   * @brief   Waiting thread on TX.
+   */
+  thread_reference_t        threadtx;
+#endif /* UART_USE_WAIT */
+#if (UART_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Mutex protecting the peripheral.
+   */
+  mutex_t                   mutex;
+#endif /* UART_USE_MUTUAL_EXCLUSION */
+#if defined(UART_DRIVER_EXT_FIELDS)
+  UART_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the UART registers block.
+   */
+  fe310_uart_t              *uart;
+  /**
+   * @brief Transmit pointer and frames left to be loaded.
+   */
+  const uint8_t             *txbuf;
+  size_t                    txn;
+  /**
+   * @brief Receive pointer and frames left to be received.
+   */
+  uint8_t                   *rxbuf;
+  size_t                    rxn;
+  /**
+   * @brief Transmission phase, buffer loading or FIFO draining.
+   */
+  uint8_t                   txphase;
+  /**
+   * @brief Duration of a character.
+   */
+  sysinterval_t             chartime;
+  /**
+   * @brief Receiver timeout interval.
+   */
+  sysinterval_t             rxgap;
+  /**
+   * @brief Time of the last RX interrupt.
+   */
+  systime_t                 rxlast;
+  /**
+   * @brief Receiver timeout timer.
+   */
+  virtual_timer_t           rxvt;
+  /**
+   * @brief Physical end of transmission timer.
+   */
+  virtual_timer_t           txvt;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (FE310_UART_USE_UART0 == TRUE) && !defined(__DOXYGEN__)
+extern UARTDriver UARTD0;
+#endif
+
+#if (FE310_UART_USE_UART1 == TRUE) && !defined(__DOXYGEN__)
+extern UARTDriver UARTD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void uart_lld_init(void);
+  void uart_lld_start(UARTDriver *uartp);
+  void uart_lld_stop(UARTDriver *uartp);
+  void uart_lld_start_send(UARTDriver *uartp, size_t n, const void *txbuf);
+  size_t uart_lld_stop_send(UARTDriver *uartp);
+  void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf);
+  size_t uart_lld_stop_receive(UARTDriver *uartp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_UART == TRUE */
+
+#endif /* HAL_UART_LLD_H */
+
+/** @} */
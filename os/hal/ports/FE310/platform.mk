@@ -10,18 +10,42 @@ HALCONF := $(strip $(shell cat $(CONFDIR)/halconf.h | egrep -e "\#define"))
 
 PLATFORMSRC := ${CHIBIOS_RV}/os/hal/ports/common/RISCV/clint/hal_st_lld.c \
                ${CHIBIOS_RV}/os/hal/ports/common/RISCV/plic/plic.c \
-               ${CHIBIOS_RV}/os/hal/ports/FE310/hal_lld.c
+               ${CHIBIOS_RV}/os/hal/ports/FE310/hal_lld.c \
+               ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_pcon.c \
+               ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_xip.c
 ifneq ($(findstring HAL_USE_PAL TRUE,$(HALCONF)),)
-PLATFORMSRC += ${CHIBIOS_RV}/os/hal/ports/FE310/hal_pal_lld.c
+PLATFORMSRC += ${CHIBIOS_RV}/os/hal/ports/FE310/hal_pal_lld.c \
+               ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_input.c \
+               ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_wave.c
+endif
+ifneq ($(findstring HAL_USE_EFL TRUE,$(HALCONF)),)
+PLATFORMSRC += ${CHIBIOS_RV}/os/hal/ports/FE310/hal_efl_lld.c
 endif
 ifneq ($(findstring HAL_USE_SERIAL TRUE,$(HALCONF)),)
 PLATFORMSRC += ${CHIBIOS_RV}/os/hal/ports/FE310/hal_serial_lld.c
 endif
+ifneq ($(findstring HAL_USE_SPI TRUE,$(HALCONF)),)
+PLATFORMSRC += ${CHIBIOS_RV}/os/hal/ports/FE310/hal_spi_lld.c
+endif
+ifneq ($(findstring HAL_USE_SIO TRUE,$(HALCONF)),)
+PLATFORMSRC += ${CHIBIOS_RV}/os/hal/ports/FE310/hal_sio_lld.c
+endif
+ifneq ($(findstring HAL_USE_UART TRUE,$(HALCONF)),)
+PLATFORMSRC += ${CHIBIOS_RV}/os/hal/ports/FE310/hal_uart_lld.c
+endif
 else
 PLATFORMSRC = ${CHIBIOS_RV}/os/hal/ports/common/RISCV/clint/hal_st_lld.c \
               ${CHIBIOS_RV}/os/hal/ports/common/RISCV/plic/plic.c \
               ${CHIBIOS_RV}/os/hal/ports/FE310/hal_lld.c \
-              ${CHIBIOS_RV}/os/hal/ports/FE310/hal_pal_lld.c
+              ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_pcon.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_xip.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/hal_efl_lld.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/hal_pal_lld.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_input.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/fe310_wave.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/hal_sio_lld.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/hal_spi_lld.c \
+              ${CHIBIOS_RV}/os/hal/ports/FE310/hal_uart_lld.c
 endif
 
 # Required include directories
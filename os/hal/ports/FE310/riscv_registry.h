@@ -44,7 +44,7 @@
 #define RISCV_HAS_PLIC
 #define PLIC_BASE               0x0C000000
 #define PLIC_MAX_PRIO           7
-#define PLIC_MAX_KERN_PRIO      5
+#define PLIC_MAX_KERN_PRIO      PORT_RISCV_MAX_KERNEL_PRIORITY
 #define PLIC_LAST_IRQ           52
 #define PLIC_NUM_CONTEXTS       1
 /** @} */
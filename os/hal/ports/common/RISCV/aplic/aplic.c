@@ -0,0 +1,611 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    common/RISCV/aplic/aplic.c
+ * @brief   RISC-V AIA (APLIC/IMSIC) support code.
+ * @note    Single hart only, all sources target hart 0 and only its
+ *          delivery control or interrupt file is programmed.
+ *
+ * @addtogroup COMMON_RISCV_APLIC
+ * @{
+ */
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+OSAL_IRQ_HANDLER(AplicUnhandledInterrupt);
+
+#if APLIC_LAST_IRQ >= 4
+OSAL_IRQ_HANDLER(AplicInterrupt1)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt2)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt3)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt4)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 8
+OSAL_IRQ_HANDLER(AplicInterrupt5)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt6)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt7)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt8)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 12
+OSAL_IRQ_HANDLER(AplicInterrupt9)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt10)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt11)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt12)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 16
+OSAL_IRQ_HANDLER(AplicInterrupt13)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt14)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt15)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt16)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 20
+OSAL_IRQ_HANDLER(AplicInterrupt17)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt18)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt19)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt20)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 24
+OSAL_IRQ_HANDLER(AplicInterrupt21)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt22)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt23)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt24)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 28
+OSAL_IRQ_HANDLER(AplicInterrupt25)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt26)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt27)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt28)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 32
+OSAL_IRQ_HANDLER(AplicInterrupt29)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt30)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt31)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt32)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 36
+OSAL_IRQ_HANDLER(AplicInterrupt33)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt34)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt35)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt36)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 40
+OSAL_IRQ_HANDLER(AplicInterrupt37)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt38)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt39)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt40)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 44
+OSAL_IRQ_HANDLER(AplicInterrupt41)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt42)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt43)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt44)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 48
+OSAL_IRQ_HANDLER(AplicInterrupt45)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt46)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt47)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt48)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 52
+OSAL_IRQ_HANDLER(AplicInterrupt49)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt50)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt51)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt52)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 56
+OSAL_IRQ_HANDLER(AplicInterrupt53)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt54)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt55)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt56)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 60
+OSAL_IRQ_HANDLER(AplicInterrupt57)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt58)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt59)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt60)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 64
+OSAL_IRQ_HANDLER(AplicInterrupt61)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt62)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt63)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt64)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 68
+OSAL_IRQ_HANDLER(AplicInterrupt65)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt66)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt67)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt68)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 72
+OSAL_IRQ_HANDLER(AplicInterrupt69)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt70)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt71)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt72)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 76
+OSAL_IRQ_HANDLER(AplicInterrupt73)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt74)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt75)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt76)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 80
+OSAL_IRQ_HANDLER(AplicInterrupt77)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt78)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt79)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt80)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 84
+OSAL_IRQ_HANDLER(AplicInterrupt81)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt82)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt83)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt84)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 88
+OSAL_IRQ_HANDLER(AplicInterrupt85)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt86)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt87)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt88)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 92
+OSAL_IRQ_HANDLER(AplicInterrupt89)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt90)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt91)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt92)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ >= 96
+OSAL_IRQ_HANDLER(AplicInterrupt93)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt94)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt95)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+OSAL_IRQ_HANDLER(AplicInterrupt96)  __attribute__((weak, alias("AplicUnhandledInterrupt")));
+#endif
+
+#if APLIC_LAST_IRQ > 96
+#error "APLIC_LAST_IRQ above the handlers provided by aplic.c"
+#endif
+
+#if (APLIC_LAST_IRQ % 4) != 0
+#error "APLIC_LAST_IRQ must be a multiple of 4"
+#endif
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+static OSAL_IRQ_HANDLER((* const aplicIntTable[APLIC_NUM_IRQS])) = {
+  // Identity 0 means no interrupt, as with the PLIC.
+  AplicUnhandledInterrupt,
+
+#if APLIC_LAST_IRQ >= 4
+  AplicInterrupt1,
+  AplicInterrupt2,
+  AplicInterrupt3,
+  AplicInterrupt4,
+#endif
+
+#if APLIC_LAST_IRQ >= 8
+  AplicInterrupt5,
+  AplicInterrupt6,
+  AplicInterrupt7,
+  AplicInterrupt8,
+#endif
+
+#if APLIC_LAST_IRQ >= 12
+  AplicInterrupt9,
+  AplicInterrupt10,
+  AplicInterrupt11,
+  AplicInterrupt12,
+#endif
+
+#if APLIC_LAST_IRQ >= 16
+  AplicInterrupt13,
+  AplicInterrupt14,
+  AplicInterrupt15,
+  AplicInterrupt16,
+#endif
+
+#if APLIC_LAST_IRQ >= 20
+  AplicInterrupt17,
+  AplicInterrupt18,
+  AplicInterrupt19,
+  AplicInterrupt20,
+#endif
+
+#if APLIC_LAST_IRQ >= 24
+  AplicInterrupt21,
+  AplicInterrupt22,
+  AplicInterrupt23,
+  AplicInterrupt24,
+#endif
+
+#if APLIC_LAST_IRQ >= 28
+  AplicInterrupt25,
+  AplicInterrupt26,
+  AplicInterrupt27,
+  AplicInterrupt28,
+#endif
+
+#if APLIC_LAST_IRQ >= 32
+  AplicInterrupt29,
+  AplicInterrupt30,
+  AplicInterrupt31,
+  AplicInterrupt32,
+#endif
+
+#if APLIC_LAST_IRQ >= 36
+  AplicInterrupt33,
+  AplicInterrupt34,
+  AplicInterrupt35,
+  AplicInterrupt36,
+#endif
+
+#if APLIC_LAST_IRQ >= 40
+  AplicInterrupt37,
+  AplicInterrupt38,
+  AplicInterrupt39,
+  AplicInterrupt40,
+#endif
+
+#if APLIC_LAST_IRQ >= 44
+  AplicInterrupt41,
+  AplicInterrupt42,
+  AplicInterrupt43,
+  AplicInterrupt44,
+#endif
+
+#if APLIC_LAST_IRQ >= 48
+  AplicInterrupt45,
+  AplicInterrupt46,
+  AplicInterrupt47,
+  AplicInterrupt48,
+#endif
+
+#if APLIC_LAST_IRQ >= 52
+  AplicInterrupt49,
+  AplicInterrupt50,
+  AplicInterrupt51,
+  AplicInterrupt52,
+#endif
+
+#if APLIC_LAST_IRQ >= 56
+  AplicInterrupt53,
+  AplicInterrupt54,
+  AplicInterrupt55,
+  AplicInterrupt56,
+#endif
+
+#if APLIC_LAST_IRQ >= 60
+  AplicInterrupt57,
+  AplicInterrupt58,
+  AplicInterrupt59,
+  AplicInterrupt60,
+#endif
+
+#if APLIC_LAST_IRQ >= 64
+  AplicInterrupt61,
+  AplicInterrupt62,
+  AplicInterrupt63,
+  AplicInterrupt64,
+#endif
+
+#if APLIC_LAST_IRQ >= 68
+  AplicInterrupt65,
+  AplicInterrupt66,
+  AplicInterrupt67,
+  AplicInterrupt68,
+#endif
+
+#if APLIC_LAST_IRQ >= 72
+  AplicInterrupt69,
+  AplicInterrupt70,
+  AplicInterrupt71,
+  AplicInterrupt72,
+#endif
+
+#if APLIC_LAST_IRQ >= 76
+  AplicInterrupt73,
+  AplicInterrupt74,
+  AplicInterrupt75,
+  AplicInterrupt76,
+#endif
+
+#if APLIC_LAST_IRQ >= 80
+  AplicInterrupt77,
+  AplicInterrupt78,
+  AplicInterrupt79,
+  AplicInterrupt80,
+#endif
+
+#if APLIC_LAST_IRQ >= 84
+  AplicInterrupt81,
+  AplicInterrupt82,
+  AplicInterrupt83,
+  AplicInterrupt84,
+#endif
+
+#if APLIC_LAST_IRQ >= 88
+  AplicInterrupt85,
+  AplicInterrupt86,
+  AplicInterrupt87,
+  AplicInterrupt88,
+#endif
+
+#if APLIC_LAST_IRQ >= 92
+  AplicInterrupt89,
+  AplicInterrupt90,
+  AplicInterrupt91,
+  AplicInterrupt92,
+#endif
+
+#if APLIC_LAST_IRQ >= 96
+  AplicInterrupt93,
+  AplicInterrupt94,
+  AplicInterrupt95,
+  AplicInterrupt96,
+#endif
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+#if APLIC_USE_MSI || defined(__DOXYGEN__)
+/**
+ * @brief   Writes an IMSIC indirect register.
+ * @note    The miselect/mireg pair is never used from the trap path, the
+ *          callers only need to be serialized against each other.
+ *
+ * @param[in] reg       the indirect register number
+ * @param[in] value     the value to be written
+ */
+static void imsic_write(uint32_t reg, uint32_t value) {
+
+  RISCV_CSR_WRITE (0x350, reg);       /* miselect */
+  RISCV_CSR_WRITE (0x351, value);     /* mireg */
+}
+
+/**
+ * @brief   Sets bits in an IMSIC indirect register.
+ *
+ * @param[in] reg       the indirect register number
+ * @param[in] mask      the bits to be set
+ */
+static void imsic_set(uint32_t reg, uint32_t mask) {
+
+  RISCV_CSR_WRITE (0x350, reg);
+  RISCV_CSR_SET (0x351, mask);
+}
+
+/**
+ * @brief   Clears bits in an IMSIC indirect register.
+ *
+ * @param[in] reg       the indirect register number
+ * @param[in] mask      the bits to be cleared
+ */
+static void imsic_clear(uint32_t reg, uint32_t mask) {
+
+  RISCV_CSR_WRITE (0x350, reg);
+  RISCV_CSR_CLEAR (0x351, mask);
+}
+#endif /* APLIC_USE_MSI */
+
+/**
+ * @brief   Claims the most urgent pending interrupt.
+ *
+ * @return              The interrupt identity, zero if none is pending.
+ */
+static inline uint32_t aplic_claim(void) {
+  uint32_t topi;
+
+#if APLIC_USE_MSI
+  /* Swapping mtopei claims the identity, no MMIO access involved.*/
+  asm volatile ("csrrw %0, 0x35C, zero" : "=r"(topi));
+  return (topi >> APLIC_TOPI_ID_SHIFT) & 0x7FFU;
+#else
+  topi = APLIC_IDC[0].CLAIMI;
+  return (topi >> APLIC_TOPI_ID_SHIFT) & APLIC_TOPI_ID_MASK;
+#endif
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   APLIC unhandled interrupt handler.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(AplicUnhandledInterrupt) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  osalSysHalt("Unhandled APLIC interrupt");
+
+  OSAL_IRQ_EPILOGUE();
+}
+
+/**
+ * @brief   AIA MEI interrupt handler.
+ * @details Unlike the PLIC there is no completion step, the claim alone
+ *          retires the interrupt.
+ *
+ * @isr
+ */
+OSAL_IRQ_HANDLER(VectorMEI) {
+  uint32_t budget = APLIC_MAX_CLAIMS_PER_TRAP;
+  uint32_t claimed;
+  uint32_t mip;
+
+  OSAL_IRQ_PROLOGUE();
+
+  while ((claimed = aplic_claim()) != 0U) {
+    if (claimed <= APLIC_LAST_IRQ)
+      aplicIntTable[claimed]();
+
+    /* Another claim only if MEIP is still pending and budget is left.*/
+    RISCV_CSR_READ (mip, mip);
+    if (((mip & 0x800U) == 0U) || (--budget == 0U))
+      break;
+  }
+
+  OSAL_IRQ_EPILOGUE();
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the APLIC domain and, in MSI mode, the IMSIC
+ *          interrupt file of hart 0.
+ * @details All sources are left inactive and disabled.
+ */
+void aplicInit(void) {
+  size_t i;
+
+  /* The domain is kept disabled while it is reconfigured.*/
+  APLIC_DOMAINCFG = 0;
+
+  for (i = 1; i < APLIC_NUM_IRQS; i++)
+    APLIC_SOURCECFG[i] = APLIC_SM_INACTIVE;
+
+  for (i = 0; i < APLIC_NUM_WORDS; i++)
+    APLIC_CLRIE[i] = 0xFFFFFFFFU;
+
+#if APLIC_USE_MSI
+  APLIC_MMSIADDRCFG  = (uint32_t)IMSIC_BASE >> 12;
+  APLIC_MMSIADDRCFGH = 0;
+
+  for (i = 0; i < APLIC_NUM_WORDS; i++) {
+    imsic_write(IMSIC_EIE0 + i, 0);
+    imsic_write(IMSIC_EIP0 + i, 0);
+  }
+  imsic_write(IMSIC_EITHRESHOLD, 0);
+  imsic_write(IMSIC_EIDELIVERY, 1);
+
+  APLIC_DOMAINCFG = APLIC_DOMAINCFG_IE | APLIC_DOMAINCFG_DM;
+#else
+  APLIC_IDC[0].ITHRESHOLD = 0;
+  APLIC_IDC[0].IDELIVERY  = 1;
+
+  APLIC_DOMAINCFG = APLIC_DOMAINCFG_IE;
+#endif
+}
+
+/**
+ * @brief   Sets the trigger mode of a source.
+ * @note    The source should be disabled while its mode is changed.
+ *
+ * @param[in] n         the interrupt number
+ * @param[in] mode      the source mode, one of the @p APLIC_SM_ values
+ */
+void aplicSetSourceMode(uint32_t n, uint32_t mode) {
+
+  osalDbgCheck((n > 0U) && (n <= APLIC_LAST_IRQ));
+
+  APLIC_SOURCECFG[n] = mode;
+}
+
+/**
+ * @brief   Sets the priority of an interrupt handler and enables it.
+ * @details A source still inactive is switched to
+ *          @p APLIC_DEFAULT_SOURCE_MODE first.
+ *
+ * @param[in] n         the interrupt number
+ * @param[in] prio      the interrupt priority, higher values are more urgent,
+ *                      ignored in MSI mode
+ */
+void aplicEnableInterrupt(uint32_t n, uint32_t prio) {
+
+  osalDbgCheck((n > 0U) && (n <= APLIC_LAST_IRQ) &&
+               (prio >= 1U) && (prio <= APLIC_MAX_PRIO));
+
+  /* The target register reads as zero while the source is inactive.*/
+  if (APLIC_SOURCECFG[n] == APLIC_SM_INACTIVE)
+    APLIC_SOURCECFG[n] = APLIC_DEFAULT_SOURCE_MODE;
+
+#if APLIC_USE_MSI
+  syssts_t sts;
+
+  (void) prio;
+  APLIC_TARGET[n] = APLIC_TARGET_HART(0) | APLIC_TARGET_EIID(n);
+
+  sts = osalSysGetStatusAndLockX();
+  imsic_set(IMSIC_EIE0 + (n / 32U), 1U << (n % 32U));
+  osalSysRestoreStatusX(sts);
+#else
+  APLIC_TARGET[n] = APLIC_TARGET_HART(0) |
+                    APLIC_TARGET_IPRIO(APLIC_MAX_PRIO + 1U - prio);
+#endif
+
+  APLIC_SETIENUM = n;
+}
+
+/**
+ * @brief   Disables an interrupt handler.
+ *
+ * @param[in] n         the interrupt number
+ */
+void aplicDisableInterrupt(uint32_t n) {
+
+  osalDbgCheck((n > 0U) && (n <= APLIC_LAST_IRQ));
+
+  APLIC_CLRIENUM = n;
+
+#if APLIC_USE_MSI
+  syssts_t sts = osalSysGetStatusAndLockX();
+  imsic_clear(IMSIC_EIE0 + (n / 32U), 1U << (n % 32U));
+  osalSysRestoreStatusX(sts);
+#endif
+}
+
+/** @} */
@@ -0,0 +1,230 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    common/RISCV/aplic/aplic.h
+ * @brief   RISC-V AIA (APLIC/IMSIC) support macros and structures.
+ * @details The driver handles the machine-level APLIC domain of hart 0,
+ *          interrupts are either delivered directly through the APLIC
+ *          interrupt delivery control or as MSIs to the IMSIC M-mode
+ *          interrupt file, see @p APLIC_USE_MSI.
+ *          The device registry must provide:
+ *          - @p RISCV_HAS_APLIC, @p APLIC_BASE and @p APLIC_LAST_IRQ.
+ *          - @p RISCV_HAS_IMSIC and @p IMSIC_BASE when MSI delivery is
+ *            used, @p IMSIC_BASE being the M-mode interrupt file of hart 0.
+ *          .
+ *          On QEMU @p virt,aia=aplic-imsic the M-mode APLIC is at
+ *          0x0C000000, the M-mode IMSIC at 0x24000000 and sources go up
+ *          to 95.
+ *
+ * @addtogroup COMMON_RISCV_APLIC
+ * @{
+ */
+
+#ifndef APLIC_H
+#define APLIC_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+#define APLIC_MAX_NUM_IRQS          1024
+
+/**
+ * @name    APLIC registers
+ * @{
+ */
+#define APLIC_DOMAINCFG     (*(volatile uint32_t *) (APLIC_BASE + 0x0000))
+#define APLIC_SOURCECFG     ((volatile uint32_t *)  (APLIC_BASE + 0x0000))
+#define APLIC_MMSIADDRCFG   (*(volatile uint32_t *) (APLIC_BASE + 0x1BC0))
+#define APLIC_MMSIADDRCFGH  (*(volatile uint32_t *) (APLIC_BASE + 0x1BC4))
+#define APLIC_SETIENUM      (*(volatile uint32_t *) (APLIC_BASE + 0x1EDC))
+#define APLIC_CLRIE         ((volatile uint32_t *)  (APLIC_BASE + 0x1F00))
+#define APLIC_CLRIENUM      (*(volatile uint32_t *) (APLIC_BASE + 0x1FDC))
+#define APLIC_TARGET        ((volatile uint32_t *)  (APLIC_BASE + 0x3000))
+#define APLIC_IDC           ((riscv_aplic_idc_t *)  (APLIC_BASE + 0x4000))
+/** @} */
+
+/**
+ * @name    DOMAINCFG register definitions
+ * @{
+ */
+#define APLIC_DOMAINCFG_IE          (1U << 8)
+#define APLIC_DOMAINCFG_DM          (1U << 2)
+#define APLIC_DOMAINCFG_BE          (1U << 0)
+/** @} */
+
+/**
+ * @name    SOURCECFG source modes
+ * @note    Indexes start from 1, as for the interrupt identities.
+ * @{
+ */
+#define APLIC_SM_INACTIVE           0U
+#define APLIC_SM_DETACHED           1U
+#define APLIC_SM_EDGE_RISE          4U
+#define APLIC_SM_EDGE_FALL          5U
+#define APLIC_SM_LEVEL_HIGH         6U
+#define APLIC_SM_LEVEL_LOW          7U
+/** @} */
+
+/**
+ * @name    TARGET register definitions
+ * @note    Indexes start from 1, as for the interrupt identities.
+ * @{
+ */
+#define APLIC_TARGET_HART(n)        ((uint32_t)(n) << 18)
+#define APLIC_TARGET_IPRIO(n)       ((uint32_t)(n) & 0xFFU)
+#define APLIC_TARGET_EIID(n)        ((uint32_t)(n) & 0x7FFU)
+/** @} */
+
+/**
+ * @name    Identity fields of TOPI, CLAIMI and MTOPEI
+ * @{
+ */
+#define APLIC_TOPI_ID_SHIFT         16
+#define APLIC_TOPI_ID_MASK          0x3FFU
+/** @} */
+
+/**
+ * @name    IMSIC indirect registers and CSRs
+ * @{
+ */
+#define IMSIC_CSR_MISELECT          0x350
+#define IMSIC_CSR_MIREG             0x351
+#define IMSIC_CSR_MTOPEI            0x35C
+
+#define IMSIC_EIDELIVERY            0x70
+#define IMSIC_EITHRESHOLD           0x72
+#define IMSIC_EIP0                  0x80
+#define IMSIC_EIE0                  0xC0
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   MSI delivery mode.
+ * @details If set to @p TRUE the APLIC forwards interrupts as MSIs to the
+ *          IMSIC and the claim is a CSR access, otherwise the APLIC direct
+ *          delivery mode is used with an MMIO claim.
+ * @note    In MSI mode the priority of a source is given by its number,
+ *          lower numbers being more urgent, as defined by the IMSIC.
+ */
+#if !defined(APLIC_USE_MSI) || defined(__DOXYGEN__)
+#define APLIC_USE_MSI                       FALSE
+#endif
+
+/**
+ * @brief   Maximum number of sources served by a single trap.
+ */
+#if !defined(APLIC_MAX_CLAIMS_PER_TRAP) || defined(__DOXYGEN__)
+#define APLIC_MAX_CLAIMS_PER_TRAP           8
+#endif
+
+/**
+ * @brief   Source mode applied by @p aplicEnableInterrupt().
+ */
+#if !defined(APLIC_DEFAULT_SOURCE_MODE) || defined(__DOXYGEN__)
+#define APLIC_DEFAULT_SOURCE_MODE           APLIC_SM_LEVEL_HIGH
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#ifndef RISCV_HAS_APLIC
+#error "aplic.h requires the device to have an APLIC"
+#endif
+
+#if !defined(APLIC_LAST_IRQ) || ((APLIC_LAST_IRQ + 1) > APLIC_MAX_NUM_IRQS)
+#error "APLIC_LAST_IRQ is invalid or not defined"
+#endif
+
+#if APLIC_USE_MSI && !defined(RISCV_HAS_IMSIC)
+#error "APLIC_USE_MSI requires the device to have an IMSIC"
+#endif
+
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+#error "the threshold based kernel lock is only supported with the PLIC"
+#endif
+
+#if APLIC_MAX_CLAIMS_PER_TRAP < 1
+#error "invalid APLIC_MAX_CLAIMS_PER_TRAP value specified"
+#endif
+
+/**
+ * @brief Readability constant for things that operate on all of the interrupts.
+ */
+#define APLIC_NUM_IRQS (APLIC_LAST_IRQ + 1)
+
+/**
+ * @brief Number of 32 bits words in an enable or pending bank.
+ */
+#define APLIC_NUM_WORDS ((APLIC_NUM_IRQS + 31) / 32)
+
+/**
+ * @brief   Number of priority levels of the API.
+ * @details Priorities passed to @p aplicEnableInterrupt() follow the PLIC
+ *          convention, higher values are more urgent, they are inverted
+ *          before being written into the APLIC.
+ */
+#define APLIC_MAX_PRIO              255
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   APLIC interrupt delivery control of a hart.
+ */
+typedef struct
+{
+    volatile uint32_t   IDELIVERY;
+    volatile uint32_t   IFORCE;
+    volatile uint32_t   ITHRESHOLD;
+    volatile uint32_t   reserved[3];
+    volatile uint32_t   TOPI;
+    volatile uint32_t   CLAIMI;
+} riscv_aplic_idc_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void aplicInit(void);
+  void aplicEnableInterrupt(uint32_t n, uint32_t prio);
+  void aplicDisableInterrupt(uint32_t n);
+  void aplicSetSourceMode(uint32_t n, uint32_t mode);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APLIC_H */
+
+/** @} */
@@ -59,10 +59,21 @@ OSAL_IRQ_HANDLER(VectorMTI) {
 
   OSAL_IRQ_PROLOGUE ();
 
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+  /* Fast PLIC sources can preempt the timer processing.*/
+  struct port_nestctx nc;
+
+  port_isr_nest_begin(&nc);
+#endif
+
   osalSysLockFromISR();
   osalOsTimerHandlerI();
   osalSysUnlockFromISR();
 
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+  port_isr_nest_end(&nc);
+#endif
+
   OSAL_IRQ_EPILOGUE ();
 }
 
@@ -76,6 +87,11 @@ OSAL_IRQ_HANDLER(VectorMTI) {
  * @notapi
  */
 void st_lld_init(void) {
+
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+  /* MTIE is left enabled by the port, the alarm starts disarmed.*/
+  st_lld_stop_alarm();
+#endif
 }
 
 #endif /* OSAL_ST_MODE != OSAL_ST_MODE_NONE */
@@ -118,8 +118,10 @@ static inline void st_lld_start_alarm(systime_t abstime) {
   RISCV_MTIMECMP0 = (uint32_t) abstime;
   RISCV_MTIMECMPH0 = (uint32_t) (abstime >> 32);
 
+#if PORT_RISCV_SIMPLIFIED_PRIORITY
   int mtie = 0x80;
   RISCV_CSR_SET (mie, mtie);
+#endif
 }
 
 /**
@@ -129,8 +131,15 @@ static inline void st_lld_start_alarm(systime_t abstime) {
  */
 static inline void st_lld_stop_alarm(void) {
 
+#if PORT_RISCV_SIMPLIFIED_PRIORITY
   int mtie = 0x80;
   RISCV_CSR_CLEAR (mie, mtie);
+#else
+  /* MTIE belongs to the kernel lock, the comparator is moved out of
+     reach instead.*/
+  RISCV_MTIMECMPH0 = 0xFFFFFFFF;
+  RISCV_MTIMECMP0 = 0xFFFFFFFF;
+#endif
 }
 
 /**
@@ -170,9 +179,13 @@ static inline systime_t st_lld_get_alarm(void) {
  */
 static inline bool st_lld_is_alarm_active(void) {
 
+#if PORT_RISCV_SIMPLIFIED_PRIORITY
   uint32_t value;
   RISCV_CSR_READ (value, MIP);
   return value & 0x80;
+#else
+  return RISCV_MTIMECMPH0 != 0xFFFFFFFF;
+#endif
 }
 
 #endif /* HAL_ST_LLD_H */
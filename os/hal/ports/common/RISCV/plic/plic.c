@@ -131,10 +131,93 @@ OSAL_IRQ_HANDLER(PlicInterrupt52)  __attribute__((weak, alias("PlicUnhandledInte
 /* Driver local types.                                                       */
 /*===========================================================================*/
 
+#if PLIC_USE_THREADED_IRQS || defined(__DOXYGEN__)
+/**
+ * @brief   Handler thread serving one PLIC priority level.
+ */
+typedef struct {
+  /* PLIC priority served, zero if the slot is free.*/
+  uint32_t                  prio;
+  /* Sources registered, at most one job each is queued.*/
+  uint32_t                  nsources;
+  /* Jobs posted by the top-half.*/
+  jobs_queue_t              jobs;
+  job_descriptor_t          jobsbuf[PLIC_THREADED_QUEUE_SIZE];
+  msg_t                     msgbuf[PLIC_THREADED_QUEUE_SIZE];
+  /* Thread working area.*/
+  THD_WORKING_AREA(wa, PLIC_THREADED_STACK_SIZE);
+} plic_thd_slot_t;
+
+/**
+ * @brief   Threaded source descriptor.
+ */
+typedef struct {
+  /* Bottom-half, NULL if the source is not threaded.*/
+  job_function_t            func;
+  void                      *arg;
+  /* Handler thread serving the source.*/
+  plic_thd_slot_t           *slot;
+} plic_thd_source_t;
+#endif
+
 /*===========================================================================*/
 /* Driver local variables.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Dispatch statistics.
+ * @note    Counters are not updated atomically, a fast source preempting
+ *          a kernel-level ISR can make them slightly inaccurate.
+ */
+static plic_stats_t plic_stats;
+
+/**
+ * @brief   Sources whose completion is written by their driver.
+ */
+static uint32_t plic_deferred[PLIC_NUM_WORDS];
+
+#if PLIC_USE_THREADED_IRQS || defined(__DOXYGEN__)
+static plic_thd_slot_t plic_thd_slots[PLIC_THREADED_NUM_THREADS];
+
+static plic_thd_source_t plic_thd_sources[PLIC_NUM_IRQS];
+#endif
+
+#if PLIC_USE_STORM_PROTECTION || defined(__DOXYGEN__)
+/**
+ * @brief   Claims of each source in the current window.
+ */
+static uint8_t plic_storm_counts[PLIC_NUM_IRQS];
+
+/**
+ * @brief   Start of the current window.
+ */
+static systime_t plic_storm_window;
+
+/**
+ * @brief   Masked sources released by the next timer expiration.
+ */
+static uint32_t plic_storm_expiring[PLIC_NUM_WORDS];
+
+/**
+ * @brief   Masked sources released by the expiration after the next one.
+ * @details These were masked while the timer was already running, waiting
+ *          one more period guarantees them the full back-off.
+ */
+static uint32_t plic_storm_waiting[PLIC_NUM_WORDS];
+
+/**
+ * @brief   Sources enabled by their driver.
+ * @details Only these are released when their back-off elapses. The
+ *          top-half of a threaded source clears its bit until the
+ *          bottom-half has run.
+ */
+static uint32_t plic_storm_enabled[PLIC_NUM_WORDS];
+
+static virtual_timer_t plic_storm_vt;
+
+static event_source_t plic_storm_es;
+#endif
+
 static OSAL_IRQ_HANDLER((* const plicIntTable[PLIC_NUM_IRQS])) = {
   // Interrupt 0 means no interrupt. This is a dummy value used to allow
   // going from the claim register to indexing into this table with
@@ -237,6 +320,256 @@ static OSAL_IRQ_HANDLER((* const plicIntTable[PLIC_NUM_IRQS])) = {
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if PLIC_USE_THREADED_IRQS || defined(__DOXYGEN__)
+/**
+ * @brief   Bottom-half of a threaded source, runs in the handler thread.
+ *
+ * @param[in] arg       the source descriptor
+ */
+static void plic_threaded_bottom_half(void *arg) {
+  plic_thd_source_t *sp = (plic_thd_source_t *)arg;
+  uint32_t n = (uint32_t)(sp - plic_thd_sources);
+  job_function_t func = sp->func;
+
+  /* The source could have been unregistered in the meantime.*/
+  if (func != NULL) {
+    func(sp->arg);
+
+    osalSysLock();
+    if (sp->func != NULL) {
+#if PLIC_USE_STORM_PROTECTION
+      /* A throttled source is enabled by the back-off timer instead.*/
+      if (plicIsInterruptThrottled(n))
+        plic_storm_enabled[n / 32U] |= 1U << (n % 32U);
+      else
+#endif
+        plicEnableInterrupt(n, sp->slot->prio);
+    }
+    osalSysUnlock();
+  }
+}
+
+/**
+ * @brief   Top-half of a threaded source, runs in the trap.
+ * @details The source is masked until the bottom-half has run, so the
+ *          claim can be completed right away.
+ *
+ * @param[in] n         the interrupt number
+ */
+static void plic_threaded_top_half(uint32_t n) {
+  plic_thd_source_t *sp = &plic_thd_sources[n];
+  job_descriptor_t *jp;
+
+  osalSysLockFromISR();
+  plicDisableInterrupt(n);
+  jp = chJobGetI(&sp->slot->jobs);
+  if (jp != NULL) {
+    jp->jobfunc = plic_threaded_bottom_half;
+    jp->jobarg  = (void *)sp;
+    chJobPostI(&sp->slot->jobs, jp);
+  }
+  else {
+    /* Only possible if a source was unregistered or moved to another
+       handler thread while its bottom-half was queued, the source is
+       left masked.*/
+    plic_stats.overflows++;
+  }
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Handler thread function.
+ *
+ * @param[in] arg       the handler thread slot
+ */
+static THD_FUNCTION(plic_threaded_dispatcher, arg) {
+  plic_thd_slot_t *tp = (plic_thd_slot_t *)arg;
+
+  chRegSetThreadName("plic");
+  while (true) {
+    (void) chJobDispatch(&tp->jobs);
+  }
+}
+
+/**
+ * @brief   Returns the handler thread serving a priority level.
+ * @details The thread is started the first time a level is used.
+ *
+ * @param[in] prio      the PLIC priority level
+ * @return              The handler thread slot.
+ */
+static plic_thd_slot_t *plic_threaded_get_slot(uint32_t prio) {
+  plic_thd_slot_t *tp;
+
+  for (tp = &plic_thd_slots[0];
+       tp < &plic_thd_slots[PLIC_THREADED_NUM_THREADS];
+       tp++) {
+    if (tp->prio == prio) {
+      return tp;
+    }
+    if (tp->prio == 0U) {
+      tp->prio = prio;
+      chJobObjectInit(&tp->jobs, PLIC_THREADED_QUEUE_SIZE,
+                      tp->jobsbuf, tp->msgbuf);
+      (void) chThdCreateStatic(tp->wa, sizeof (tp->wa),
+                               PLIC_THREADED_PRIO_BASE + prio,
+                               plic_threaded_dispatcher, tp);
+      return tp;
+    }
+  }
+
+  return NULL;
+}
+#endif /* PLIC_USE_THREADED_IRQS */
+
+#if PLIC_USE_STORM_PROTECTION || defined(__DOXYGEN__)
+/**
+ * @brief   Back-off timer callback.
+ * @details Enables the sources whose back-off elapsed and that are still
+ *          enabled by their driver, the timer is restarted if others are
+ *          still waiting.
+ *
+ * @param[in] p         not used
+ */
+static void plic_storm_release(void *p) {
+  uint32_t waiting = 0U;
+  size_t i;
+
+  (void) p;
+
+  osalSysLockFromISR();
+  for (i = 0; i < PLIC_NUM_WORDS; i++) {
+    PLIC_EN->CONTEXTS[0].EN[i] |= plic_storm_expiring[i] &
+                                  plic_storm_enabled[i];
+    plic_storm_expiring[i] = plic_storm_waiting[i];
+    plic_storm_waiting[i] = 0U;
+    waiting |= plic_storm_expiring[i];
+  }
+  if (waiting != 0U)
+    chVTSetI(&plic_storm_vt, PLIC_STORM_BACKOFF, plic_storm_release, NULL);
+  osalEventBroadcastFlagsI(&plic_storm_es, PLIC_STORM_SOURCE_RESTORED);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Accounts a claim and masks the source if over its budget.
+ * @details All the counters are cleared when a window elapses, the
+ *          window start is only moved by the claims.
+ *
+ * @param[in] n         the interrupt number
+ */
+static void plic_storm_account(uint32_t n) {
+  systime_t now = osalOsGetSystemTimeX();
+  size_t i;
+
+  if (osalTimeDiffX(plic_storm_window, now) >= PLIC_STORM_WINDOW) {
+    plic_storm_window = now;
+    for (i = 0; i < PLIC_NUM_IRQS; i++)
+      plic_storm_counts[i] = 0U;
+  }
+
+  if (plic_storm_counts[n] < PLIC_STORM_MAX_CLAIMS) {
+    plic_storm_counts[n]++;
+    return;
+  }
+
+  plic_storm_counts[n] = 0U;
+  plic_stats.throttled++;
+
+  osalSysLockFromISR();
+  /* Masked without clearing the driver enable.*/
+  PLIC_EN->CONTEXTS[0].EN[n / 32U] &= ~(1U << (n % 32U));
+  if (!chVTIsArmedI(&plic_storm_vt)) {
+    plic_storm_expiring[n / 32U] |= 1U << (n % 32U);
+    chVTSetI(&plic_storm_vt, PLIC_STORM_BACKOFF, plic_storm_release, NULL);
+  }
+  else {
+    plic_storm_waiting[n / 32U] |= 1U << (n % 32U);
+  }
+  osalEventBroadcastFlagsI(&plic_storm_es, PLIC_STORM_SOURCE_MASKED);
+  osalSysUnlockFromISR();
+}
+#endif /* PLIC_USE_STORM_PROTECTION */
+
+/**
+ * @brief   Claim loop.
+ * @details At most @p PLIC_MAX_CLAIMS_PER_TRAP sources are served, the
+ *          @p mip.MEIP bit is checked before reading the claim register
+ *          again so the last MMIO read returning zero is usually avoided.
+ *
+ * @param[in] kernel    @p true if the handlers run at kernel level
+ */
+static inline void plic_serve_claims(bool kernel) {
+  uint32_t budget = PLIC_MAX_CLAIMS_PER_TRAP;
+  uint32_t claimed;
+  uint32_t mip;
+
+#if PORT_RISCV_SIMPLIFIED_PRIORITY && !PLIC_USE_THREADED_IRQS &&          \
+    !PLIC_USE_STORM_PROTECTION
+  (void) kernel;
+#endif
+
+  claimed = *PLIC_CLAIM_COMPLETE;
+  if (claimed == 0U) {
+    /* Pending state already withdrawn, usually a source served by the
+       previous trap whose request had not yet been cleared.*/
+    plic_stats.spurious++;
+    return;
+  }
+
+  plic_stats.traps++;
+  while (true) {
+    if (claimed > PLIC_LAST_IRQ) {
+      /* Not implemented in the table, nothing to dispatch. Completed anyway
+         or the gateway of the source would stay locked.*/
+      plic_stats.invalid++;
+      *PLIC_CLAIM_COMPLETE = claimed;
+    }
+    else {
+      plic_stats.claims++;
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+      /* The source is claimed with a zero threshold, then the handler runs
+         under the kernel lock so that fast sources can preempt it.*/
+      struct port_nestctx nc;
+
+      if (kernel)
+        port_isr_nest_begin(&nc);
+#endif
+#if PLIC_USE_THREADED_IRQS
+      if (kernel && (plic_thd_sources[claimed].func != NULL))
+        plic_threaded_top_half(claimed);
+      else
+#endif
+        plicIntTable[claimed]();
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+      if (kernel)
+        port_isr_nest_end(&nc);
+#endif
+      if ((plic_deferred[claimed / 32U] & (1U << (claimed % 32U))) == 0U)
+        *PLIC_CLAIM_COMPLETE = claimed;
+#if PLIC_USE_STORM_PROTECTION
+      if (kernel)
+        plic_storm_account(claimed);
+#endif
+    }
+
+    RISCV_CSR_READ (mip, mip);
+    if ((mip & 0x800) == 0U)
+      break;
+
+    if (--budget == 0U) {
+      /* Still pending, the rest is served by the next trap after a
+         possible reschedule.*/
+      plic_stats.budget_exhausted++;
+      break;
+    }
+
+    claimed = *PLIC_CLAIM_COMPLETE;
+    if (claimed == 0U)
+      break;
+  }
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -262,15 +595,18 @@ OSAL_IRQ_HANDLER(PlicUnhandledInterrupt) {
  */
 OSAL_IRQ_HANDLER(VectorMEI) {
 
-  OSAL_IRQ_PROLOGUE();
+#if !PORT_RISCV_SIMPLIFIED_PRIORITY
+  if (port_is_kernel_locked()) {
+    /* The trap preempted a kernel critical zone or a kernel-level ISR,
+       the claim only returns fast sources and no OS API can be used.*/
+    plic_serve_claims(false);
+    return false;
+  }
+#endif
 
-  uint32_t claimed;
+  OSAL_IRQ_PROLOGUE();
 
-  while ((claimed = *PLIC_CLAIM_COMPLETE) != 0)
-  {
-    plicIntTable[claimed]();
-    *PLIC_CLAIM_COMPLETE = claimed;
-  }
+  plic_serve_claims(true);
 
   OSAL_IRQ_EPILOGUE();
 }
@@ -294,34 +630,219 @@ void plicInit(void) {
     PLIC_PRIO->PRIO[i] = 0;
 
   for (i = 0; i < PLIC_NUM_CONTEXTS; i++)
-    for (j = 0; j < PLIC_NUM_IRQS / sizeof (uint32_t); j++)
+    for (j = 0; j < PLIC_NUM_WORDS; j++)
       PLIC_EN->CONTEXTS[i].EN[j] = 0;
 
   // TODO: Should this live here?
   for (i = 0; i < PLIC_NUM_CONTEXTS; i++)
     PLIC_CONTEXTS->CONTEXTS[i].PRIO_THRESH = 0;
+
+#if PLIC_USE_STORM_PROTECTION
+  chVTObjectInit(&plic_storm_vt);
+  osalEventObjectInit(&plic_storm_es);
+#endif
 }
 
 /**
  * @brief   Sets the priority of an interrupt handler and enables it.
+ * @note    The enable bank is shared with the storm protection, it is
+ *          updated under the kernel lock.
  *
  * @param[in] n         the interrupt number
  * @param[in] prio      the interrupt priority
+ *
+ * @xclass
  */
 void plicEnableInterrupt(uint32_t n, uint32_t prio) {
+  syssts_t sts;
 
+  osalDbgCheck((n > 0U) && (n <= PLIC_LAST_IRQ) &&
+               OSAL_IRQ_IS_VALID_PRIORITY(prio));
+
+  sts = osalSysGetStatusAndLockX();
   PLIC_PRIO->PRIO[n] = prio;
-  PLIC_EN->CONTEXTS[0].EN[n / sizeof (uint32_t)] |= 1 << (n % sizeof (uint32_t));
+  PLIC_EN->CONTEXTS[0].EN[n / 32U] |= 1U << (n % 32U);
+#if PLIC_USE_STORM_PROTECTION
+  plic_storm_enabled[n / 32U] |= 1U << (n % 32U);
+#endif
+  osalSysRestoreStatusX(sts);
 }
 
 /**
  * @brief   Disables an interrupt handler.
+ * @note    The enable bank is shared with the storm protection, it is
+ *          updated under the kernel lock.
  *
  * @param[in] n         the interrupt number
+ *
+ * @xclass
  */
 void plicDisableInterrupt(uint32_t n) {
+  syssts_t sts;
+
+  osalDbgCheck((n > 0U) && (n <= PLIC_LAST_IRQ));
+
+  sts = osalSysGetStatusAndLockX();
+  PLIC_EN->CONTEXTS[0].EN[n / 32U] &= ~(1U << (n % 32U));
+#if PLIC_USE_STORM_PROTECTION
+  plic_storm_enabled[n / 32U] &= ~(1U << (n % 32U));
+#endif
+  osalSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Selects who writes the completion of a source.
+ * @details By default the completion is written as soon as the handler
+ *          returns. A deferred source stays in service after its handler,
+ *          the PLIC does not forward it again until the driver invokes
+ *          @p plicCompleteInterrupt(), this is meant for level-triggered
+ *          sources that are only cleared when the driver is done.
+ *
+ * @param[in] n         the interrupt number
+ * @param[in] deferred  @p true if the driver completes the source
+ */
+void plicSetDeferredCompletion(uint32_t n, bool deferred) {
+  syssts_t sts;
+
+  osalDbgCheck((n > 0U) && (n <= PLIC_LAST_IRQ));
+
+  sts = osalSysGetStatusAndLockX();
+  if (deferred)
+    plic_deferred[n / 32U] |= 1U << (n % 32U);
+  else
+    plic_deferred[n / 32U] &= ~(1U << (n % 32U));
+  osalSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Completes a deferred source.
+ *
+ * @param[in] n         the interrupt number
+ *
+ * @iclass
+ */
+void plicCompleteInterrupt(uint32_t n) {
+
+  osalDbgCheck((n > 0U) && (n <= PLIC_LAST_IRQ));
+
+  *PLIC_CLAIM_COMPLETE = n;
+}
+
+/**
+ * @brief   Returns the dispatch statistics.
+ *
+ * @return              Pointer to the statistics counters.
+ */
+const plic_stats_t *plicGetStatistics(void) {
+
+  return &plic_stats;
+}
+
+#if PLIC_USE_THREADED_IRQS || defined(__DOXYGEN__)
+/**
+ * @brief   Enables a source in threaded mode.
+ * @details The trap only masks the source and posts @p func to the handler
+ *          thread of the @p prio level, the source is enabled again after
+ *          @p func returned.
+ * @note    Threaded sources must have a kernel-level priority.
+ * @note    Must be called from thread context after the kernel has been
+ *          initialized, registrations are expected to happen at startup
+ *          and are not serialized against each other.
+ * @note    A handler thread serves at most @p PLIC_THREADED_QUEUE_SIZE
+ *          sources, each one can have a single bottom-half queued.
+ *
+ * @param[in] n         the interrupt number
+ * @param[in] prio      the interrupt priority
+ * @param[in] func      the bottom-half function
+ * @param[in] arg       the bottom-half argument
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  if the source has been registered.
+ * @retval HAL_FAILED   if no handler thread is available for @p prio or
+ *                      its jobs queue cannot take another source.
+ */
+bool plicEnableThreadedInterrupt(uint32_t n, uint32_t prio,
+                                 job_function_t func, void *arg) {
+  plic_thd_source_t *sp = &plic_thd_sources[n];
+  plic_thd_slot_t *tp;
+
+  osalDbgCheck((n > 0U) && (n <= PLIC_LAST_IRQ) && (func != NULL) &&
+               OSAL_IRQ_IS_VALID_KERNEL_PRIORITY(prio));
+
+  tp = plic_threaded_get_slot(prio);
+  if (tp == NULL)
+    return HAL_FAILED;
+
+  osalSysLock();
+  if ((sp->func == NULL) || (sp->slot != tp)) {
+    if (tp->nsources >= PLIC_THREADED_QUEUE_SIZE) {
+      osalSysUnlock();
+      return HAL_FAILED;
+    }
+    if (sp->func != NULL)
+      sp->slot->nsources--;
+    tp->nsources++;
+  }
+  sp->slot = tp;
+  sp->arg  = arg;
+  sp->func = func;
+  plicEnableInterrupt(n, prio);
+  osalSysUnlock();
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Disables a threaded source.
+ * @note    A bottom-half already posted is discarded.
+ *
+ * @param[in] n         the interrupt number
+ */
+void plicDisableThreadedInterrupt(uint32_t n) {
+
+  osalDbgCheck((n > 0U) && (n <= PLIC_LAST_IRQ));
+
+  osalSysLock();
+  plicDisableInterrupt(n);
+  if (plic_thd_sources[n].func != NULL) {
+    plic_thd_sources[n].slot->nsources--;
+    plic_thd_sources[n].func = NULL;
+  }
+  osalSysUnlock();
+}
+#endif /* PLIC_USE_THREADED_IRQS */
+
+#if PLIC_USE_STORM_PROTECTION || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the storm event source.
+ * @details The source is broadcast with @p PLIC_STORM_SOURCE_MASKED when
+ *          a source is masked and with @p PLIC_STORM_SOURCE_RESTORED when
+ *          sources are enabled again, @p plicIsInterruptThrottled() tells
+ *          which ones.
+ *
+ * @return              Pointer to the event source.
+ */
+event_source_t *plicGetStormEventSource(void) {
+
+  return &plic_storm_es;
+}
+
+/**
+ * @brief   Tells if a source is masked by the storm protection.
+ *
+ * @param[in] n         the interrupt number
+ * @return              The throttling state.
+ * @retval false        if the source is not throttled.
+ * @retval true         if the source is masked until its back-off elapses.
+ *
+ * @xclass
+ */
+bool plicIsInterruptThrottled(uint32_t n) {
+
+  osalDbgCheck((n > 0U) && (n <= PLIC_LAST_IRQ));
 
-  PLIC_EN->CONTEXTS[0].EN[n / sizeof (uint32_t)] &= ~(1 << (n % sizeof (uint32_t)));
+  return ((plic_storm_expiring[n / 32U] | plic_storm_waiting[n / 32U]) &
+          (1U << (n % 32U))) != 0U;
 }
+#endif /* PLIC_USE_STORM_PROTECTION */
 
 /** @} */
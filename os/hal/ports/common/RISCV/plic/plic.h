@@ -44,6 +44,99 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Maximum number of sources served by a single trap.
+ * @details Sources still pending are served by the following trap, this
+ *          bounds the time spent in the claim loop under interrupt storms.
+ */
+#if !defined(PLIC_MAX_CLAIMS_PER_TRAP) || defined(__DOXYGEN__)
+#define PLIC_MAX_CLAIMS_PER_TRAP            8
+#endif
+
+/**
+ * @brief   Threaded interrupts support.
+ * @details If set to @p TRUE sources can be registered with
+ *          @p plicEnableThreadedInterrupt(), their handlers are then run
+ *          by a handler thread instead of the trap.
+ */
+#if !defined(PLIC_USE_THREADED_IRQS) || defined(__DOXYGEN__)
+#define PLIC_USE_THREADED_IRQS              FALSE
+#endif
+
+/**
+ * @brief   Number of handler threads.
+ * @details One thread is needed for each PLIC priority level used by
+ *          threaded sources, sources on the same level share it.
+ */
+#if !defined(PLIC_THREADED_NUM_THREADS) || defined(__DOXYGEN__)
+#define PLIC_THREADED_NUM_THREADS           1
+#endif
+
+/**
+ * @brief   Jobs queue size of each handler thread.
+ * @note    A masked source cannot post twice, this is also the number of
+ *          threaded sources a thread accepts.
+ */
+#if !defined(PLIC_THREADED_QUEUE_SIZE) || defined(__DOXYGEN__)
+#define PLIC_THREADED_QUEUE_SIZE            4
+#endif
+
+/**
+ * @brief   Stack size of each handler thread.
+ */
+#if !defined(PLIC_THREADED_STACK_SIZE) || defined(__DOXYGEN__)
+#define PLIC_THREADED_STACK_SIZE            256
+#endif
+
+/**
+ * @brief   Thread priority for PLIC priority level zero.
+ * @details A handler thread runs at this priority plus the PLIC priority
+ *          of the sources it serves.
+ */
+#if !defined(PLIC_THREADED_PRIO_BASE) || defined(__DOXYGEN__)
+#define PLIC_THREADED_PRIO_BASE             (HIGHPRIO - 1 - PLIC_MAX_PRIO)
+#endif
+
+/**
+ * @brief   Interrupt storm protection.
+ * @details If set to @p TRUE a source claimed more than
+ *          @p PLIC_STORM_MAX_CLAIMS times within a @p PLIC_STORM_WINDOW
+ *          window is masked, it is enabled again by a virtual timer after
+ *          at least @p PLIC_STORM_BACKOFF unless its driver disabled it
+ *          meanwhile.
+ * @note    Only kernel-level sources are accounted, fast sources cannot
+ *          use the virtual timers.
+ */
+#if !defined(PLIC_USE_STORM_PROTECTION) || defined(__DOXYGEN__)
+#define PLIC_USE_STORM_PROTECTION           FALSE
+#endif
+
+/**
+ * @brief   Claims allowed to a source within a window.
+ */
+#if !defined(PLIC_STORM_MAX_CLAIMS) || defined(__DOXYGEN__)
+#define PLIC_STORM_MAX_CLAIMS               100
+#endif
+
+/**
+ * @brief   Accounting window.
+ */
+#if !defined(PLIC_STORM_WINDOW) || defined(__DOXYGEN__)
+#define PLIC_STORM_WINDOW                   TIME_MS2I(10)
+#endif
+
+/**
+ * @brief   Minimum time a source stays masked after a storm.
+ */
+#if !defined(PLIC_STORM_BACKOFF) || defined(__DOXYGEN__)
+#define PLIC_STORM_BACKOFF                  TIME_MS2I(100)
+#endif
+/** @} */
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -65,6 +158,44 @@
  */
 #define PLIC_NUM_IRQS (PLIC_LAST_IRQ + 1)
 
+/**
+ * @brief Number of 32 bits words in an enable or pending bank.
+ */
+#define PLIC_NUM_WORDS ((PLIC_NUM_IRQS + 31) / 32)
+
+#if PLIC_MAX_CLAIMS_PER_TRAP < 1
+#error "invalid PLIC_MAX_CLAIMS_PER_TRAP value specified"
+#endif
+
+#if PLIC_USE_THREADED_IRQS || defined(__DOXYGEN__)
+#if !CH_CFG_USE_JOBS
+#error "PLIC_USE_THREADED_IRQS requires CH_CFG_USE_JOBS"
+#endif
+
+#if PLIC_THREADED_NUM_THREADS < 1
+#error "invalid PLIC_THREADED_NUM_THREADS value specified"
+#endif
+
+#if PLIC_THREADED_QUEUE_SIZE < 1
+#error "invalid PLIC_THREADED_QUEUE_SIZE value specified"
+#endif
+
+#if (PLIC_THREADED_PRIO_BASE <= LOWPRIO) ||                                 \
+    ((PLIC_THREADED_PRIO_BASE + PLIC_MAX_PRIO) > HIGHPRIO)
+#error "invalid PLIC_THREADED_PRIO_BASE value specified"
+#endif
+#endif /* PLIC_USE_THREADED_IRQS */
+
+#if PLIC_USE_STORM_PROTECTION || defined(__DOXYGEN__)
+#if !CH_CFG_USE_EVENTS
+#error "PLIC_USE_STORM_PROTECTION requires CH_CFG_USE_EVENTS"
+#endif
+
+#if (PLIC_STORM_MAX_CLAIMS < 1) || (PLIC_STORM_MAX_CLAIMS > 255)
+#error "invalid PLIC_STORM_MAX_CLAIMS value specified"
+#endif
+#endif /* PLIC_USE_STORM_PROTECTION */
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -100,10 +231,54 @@ typedef struct
     riscv_plic_context_t    CONTEXTS[PLIC_MAX_NUM_CONTEXTS];
 } riscv_plic_contexts_t;
 
+/**
+ * @brief   PLIC dispatch statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Traps that claimed at least one source.
+   */
+  uint32_t                  traps;
+  /**
+   * @brief   Sources dispatched.
+   */
+  uint32_t                  claims;
+  /**
+   * @brief   Traps whose first claim returned zero.
+   */
+  uint32_t                  spurious;
+  /**
+   * @brief   Claims returning an ID above @p PLIC_LAST_IRQ.
+   */
+  uint32_t                  invalid;
+  /**
+   * @brief   Traps ended by @p PLIC_MAX_CLAIMS_PER_TRAP with sources
+   *          still pending.
+   */
+  uint32_t                  budget_exhausted;
+  /**
+   * @brief   Sources masked by the storm protection.
+   */
+  uint32_t                  throttled;
+  /**
+   * @brief   Threaded sources left masked because the jobs queue of their
+   *          handler thread was full.
+   */
+  uint32_t                  overflows;
+} plic_stats_t;
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @name    Storm event flags
+ * @{
+ */
+#define PLIC_STORM_SOURCE_MASKED    (eventflags_t)1
+#define PLIC_STORM_SOURCE_RESTORED  (eventflags_t)2
+/** @} */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -114,6 +289,18 @@ extern "C" {
   void plicInit(void);
   void plicEnableInterrupt(uint32_t n, uint32_t prio);
   void plicDisableInterrupt(uint32_t n);
+  void plicSetDeferredCompletion(uint32_t n, bool deferred);
+  void plicCompleteInterrupt(uint32_t n);
+  const plic_stats_t *plicGetStatistics(void);
+#if PLIC_USE_THREADED_IRQS
+  bool plicEnableThreadedInterrupt(uint32_t n, uint32_t prio,
+                                   job_function_t func, void *arg);
+  void plicDisableThreadedInterrupt(uint32_t n);
+#endif
+#if PLIC_USE_STORM_PROTECTION
+  event_source_t *plicGetStormEventSource(void);
+  bool plicIsInterruptThrottled(uint32_t n);
+#endif
 #ifdef __cplusplus
 }
 #endif
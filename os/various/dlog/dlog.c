@@ -0,0 +1,287 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    various/dlog/dlog.c
+ * @brief   Deferred binary logger code.
+ * @details Records are laid out in the ring as a header word, a time
+ *          stamp word and the arguments. Producers reserve space with
+ *          a compare and swap on the write index and store the header
+ *          last, a zero header marks a record not yet committed. The
+ *          drain thread zeroes the words it consumed before releasing
+ *          them.
+ *          Each record is sent as a COBS frame terminated by a zero
+ *          byte, the payload is:
+ *          - varint, format string offset in @p .dlog shifted left by
+ *            one, or number of dropped records shifted left by one with
+ *            bit zero set.
+ *          - varint, @p mcycle ticks since the previous record, modulo
+ *            2^32.
+ *          - arguments, 32 bits little endian each.
+ *          .
+ *
+ * @addtogroup DLOG
+ * @{
+ */
+
+#include "ch.h"
+#include "hal.h"
+#include "dlog.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+#define DLOG_MASK                   ((uint32_t)DLOG_BUFFER_SIZE - 1U)
+
+#define DLOG_HDR_VALID              1U
+#define DLOG_HDR_NARGS(n)           ((uint32_t)(n) << 4)
+#define DLOG_HDR_ID(id)             ((uint32_t)(id) << 8)
+#define DLOG_HDR_GET_NARGS(h)       (((h) >> 4) & 15U)
+#define DLOG_HDR_GET_ID(h)          ((h) >> 8)
+
+/* Largest payload, two 5 bytes varints plus the arguments.*/
+#define DLOG_PAYLOAD_SIZE           (10 + (DLOG_MAX_ARGS * 4))
+
+/* COBS overhead byte and delimiter, payloads are shorter than 254 bytes.*/
+#define DLOG_FRAME_SIZE             (DLOG_PAYLOAD_SIZE + 2)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Records ring.
+ */
+static uint32_t dlog_ring[DLOG_BUFFER_SIZE];
+
+/**
+ * @brief   Free running write and read indexes.
+ */
+static uint32_t dlog_wr;
+static uint32_t dlog_rd;
+
+/**
+ * @brief   Records dropped because the ring was full.
+ */
+static uint32_t dlog_dropped;
+
+/**
+ * @brief   Drain thread working area.
+ */
+static THD_WORKING_AREA(dlog_wa, DLOG_THREAD_STACK_SIZE);
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Appends an unsigned LEB128 value.
+ *
+ * @param[out] p        output pointer
+ * @param[in] v         value to be encoded
+ * @return              The pointer past the encoded value.
+ */
+static uint8_t *dlog_put_varint(uint8_t *p, uint32_t v) {
+
+  while (v >= 0x80U) {
+    *p++ = (uint8_t)(v | 0x80U);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+
+  return p;
+}
+
+/**
+ * @brief   COBS encodes a payload and appends the delimiter.
+ *
+ * @param[out] dst      frame buffer, at least @p n plus two bytes
+ * @param[in] src       payload, shorter than 254 bytes
+ * @param[in] n         payload size
+ * @return              The frame size.
+ */
+static size_t dlog_cobs_encode(uint8_t *dst, const uint8_t *src, size_t n) {
+  uint8_t *code = dst;
+  uint8_t *p = dst + 1;
+  size_t i;
+
+  for (i = 0U; i < n; i++) {
+    if (src[i] == 0U) {
+      *code = (uint8_t)(p - code);
+      code = p++;
+    }
+    else {
+      *p++ = src[i];
+    }
+  }
+  *code = (uint8_t)(p - code);
+  *p++ = 0U;
+
+  return (size_t)(p - dst);
+}
+
+/**
+ * @brief   Sends one frame.
+ *
+ * @param[in] stream    output stream
+ * @param[in] payload   frame payload
+ * @param[in] n         payload size
+ */
+static void dlog_send(BaseSequentialStream *stream,
+                      const uint8_t *payload, size_t n) {
+  uint8_t frame[DLOG_FRAME_SIZE];
+
+  (void) streamWrite(stream, frame, dlog_cobs_encode(frame, payload, n));
+}
+
+/**
+ * @brief   Drain thread function.
+ *
+ * @param[in] arg       the output stream
+ */
+static THD_FUNCTION(dlog_drain, arg) {
+  BaseSequentialStream *stream = (BaseSequentialStream *)arg;
+  uint8_t payload[DLOG_PAYLOAD_SIZE];
+  uint32_t reported = 0U;
+  uint32_t last = 0U;
+
+  chRegSetThreadName("dlog");
+  while (true) {
+    uint32_t rd = __atomic_load_n(&dlog_rd, __ATOMIC_RELAXED);
+    uint32_t hdr = __atomic_load_n(&dlog_ring[rd & DLOG_MASK],
+                                   __ATOMIC_ACQUIRE);
+    uint32_t dropped = __atomic_load_n(&dlog_dropped, __ATOMIC_RELAXED);
+    uint32_t i, n, ts;
+    uint8_t *p;
+
+    if (dropped != reported) {
+      p = dlog_put_varint(payload,
+                          ((dropped - reported) << 1) | DLOG_FRAME_DROPPED);
+      p = dlog_put_varint(p, 0U);
+      dlog_send(stream, payload, (size_t)(p - payload));
+      reported = dropped;
+    }
+
+    /* Nothing committed at the read index, either the ring is empty or
+       the producer has been preempted while writing its record.*/
+    if (hdr == 0U) {
+      chThdSleep(DLOG_DRAIN_INTERVAL);
+      continue;
+    }
+
+    n = DLOG_HDR_GET_NARGS(hdr);
+    ts = dlog_ring[(rd + 1U) & DLOG_MASK];
+    p = dlog_put_varint(payload,
+                        (DLOG_HDR_GET_ID(hdr) << 1) | DLOG_FRAME_RECORD);
+    p = dlog_put_varint(p, ts - last);
+    last = ts;
+    for (i = 0U; i < n; i++) {
+      uint32_t a = dlog_ring[(rd + 2U + i) & DLOG_MASK];
+      *p++ = (uint8_t)a;
+      *p++ = (uint8_t)(a >> 8);
+      *p++ = (uint8_t)(a >> 16);
+      *p++ = (uint8_t)(a >> 24);
+    }
+
+    /* Releasing the words, free space must read as zero.*/
+    for (i = 0U; i < n + 2U; i++) {
+      dlog_ring[(rd + i) & DLOG_MASK] = 0U;
+    }
+    __atomic_store_n(&dlog_rd, rd + n + 2U, __ATOMIC_RELEASE);
+
+    /* The stream can block, the ring keeps absorbing records meanwhile.*/
+    dlog_send(stream, payload, (size_t)(p - payload));
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts the drain thread.
+ * @details Records posted before this call are kept in the ring.
+ *
+ * @param[in] stream    output stream, for example @p SD0
+ *
+ * @api
+ */
+void dlogStart(BaseSequentialStream *stream) {
+
+  osalDbgCheck(stream != NULL);
+
+  (void) chThdCreateStatic(dlog_wa, sizeof(dlog_wa), DLOG_THREAD_PRIORITY,
+                           dlog_drain, (void *)stream);
+}
+
+/**
+ * @brief   Posts a log record.
+ * @note    Lock-free, it can be called from any context.
+ * @note    Use the @p DLOG() macro instead.
+ *
+ * @param[in] id        format string address in the @p .dlog section
+ * @param[in] args      the arguments
+ * @param[in] nargs     number of arguments
+ *
+ * @notapi
+ */
+void dlogPost(uint32_t id, const uint32_t *args, uint32_t nargs) {
+  uint32_t ts, wr, rd, i;
+
+  RISCV_CSR_READ(ts, mcycle);
+
+  wr = __atomic_load_n(&dlog_wr, __ATOMIC_RELAXED);
+  do {
+    rd = __atomic_load_n(&dlog_rd, __ATOMIC_ACQUIRE);
+    if ((wr - rd) > ((uint32_t)DLOG_BUFFER_SIZE - 2U - nargs)) {
+      (void) __atomic_fetch_add(&dlog_dropped, 1U, __ATOMIC_RELAXED);
+      return;
+    }
+  } while (!__atomic_compare_exchange_n(&dlog_wr, &wr, wr + 2U + nargs,
+                                        true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED));
+
+  dlog_ring[(wr + 1U) & DLOG_MASK] = ts;
+  for (i = 0U; i < nargs; i++) {
+    dlog_ring[(wr + 2U + i) & DLOG_MASK] = args[i];
+  }
+  __atomic_store_n(&dlog_ring[wr & DLOG_MASK],
+                   DLOG_HDR_ID(id) | DLOG_HDR_NARGS(nargs) | DLOG_HDR_VALID,
+                   __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief   Returns the number of records dropped since startup.
+ *
+ * @return              The dropped records count.
+ *
+ * @api
+ */
+uint32_t dlogGetDropped(void) {
+
+  return __atomic_load_n(&dlog_dropped, __ATOMIC_RELAXED);
+}
+
+/** @} */
@@ -0,0 +1,158 @@
+/*
+    ChibiOS - Copyright (C) 2020 Patrick Seidel
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    various/dlog/dlog.h
+ * @brief   Deferred binary logger macros and structures.
+ * @details Log calls store the address of their format string, the low
+ *          word of @p mcycle and the raw arguments into a RAM ring, the
+ *          text is never formatted on the target. Format strings are
+ *          placed into the @p .dlog section which is not loaded, the
+ *          host decoder reads them back from the ELF file.
+ *
+ * @addtogroup DLOG
+ * @{
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Frame types
+ * @{
+ */
+#define DLOG_FRAME_RECORD                   0U
+#define DLOG_FRAME_DROPPED                  1U
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Ring size in words.
+ * @note    Must be a power of two. A record takes two words plus one
+ *          word per argument.
+ */
+#if !defined(DLOG_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define DLOG_BUFFER_SIZE                    256
+#endif
+
+/**
+ * @brief   Maximum number of arguments of a log call.
+ */
+#if !defined(DLOG_MAX_ARGS) || defined(__DOXYGEN__)
+#define DLOG_MAX_ARGS                       8
+#endif
+
+/**
+ * @brief   Drain thread working area size.
+ */
+#if !defined(DLOG_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define DLOG_THREAD_STACK_SIZE              256
+#endif
+
+/**
+ * @brief   Drain thread priority.
+ */
+#if !defined(DLOG_THREAD_PRIORITY) || defined(__DOXYGEN__)
+#define DLOG_THREAD_PRIORITY                (LOWPRIO + 1)
+#endif
+
+/**
+ * @brief   Drain thread polling interval when the ring is empty.
+ */
+#if !defined(DLOG_DRAIN_INTERVAL) || defined(__DOXYGEN__)
+#define DLOG_DRAIN_INTERVAL                 TIME_MS2I(10)
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (DLOG_BUFFER_SIZE & (DLOG_BUFFER_SIZE - 1)) != 0
+#error "DLOG_BUFFER_SIZE must be a power of two"
+#endif
+
+#if (DLOG_MAX_ARGS < 0) || (DLOG_MAX_ARGS > 15)
+#error "DLOG_MAX_ARGS must be within 0..15"
+#endif
+
+#if DLOG_BUFFER_SIZE < (2 + DLOG_MAX_ARGS)
+#error "DLOG_BUFFER_SIZE too small for DLOG_MAX_ARGS"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Posts a log record.
+ * @details Arguments are stored as 32 bits words, they must be integers
+ *          or be cast to integers. A @p %s argument must point to a
+ *          string in flash, the host reads it from the ELF file.
+ * @note    Can be called from any context, including interrupts above
+ *          the kernel priority. The record is dropped if the ring is full.
+ *
+ * @param[in] fmt       format string literal
+ * @param[in] ...       up to @p DLOG_MAX_ARGS integer arguments
+ *
+ * @api
+ */
+#define DLOG(fmt, ...) do {                                                 \
+  static const char _dlog_fmt[]                                             \
+      __attribute__((section(".dlog"), used)) = fmt;                        \
+  const uint32_t _dlog_args[] = {0U, ##__VA_ARGS__};                        \
+  _Static_assert((sizeof(_dlog_args) / sizeof(uint32_t)) - 1U <=            \
+                 DLOG_MAX_ARGS, "too many DLOG arguments");                 \
+  dlogPost((uint32_t)_dlog_fmt, &_dlog_args[1],                             \
+           (sizeof(_dlog_args) / sizeof(uint32_t)) - 1U);                   \
+} while (false)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void dlogStart(BaseSequentialStream *stream);
+  void dlogPost(uint32_t id, const uint32_t *args, uint32_t nargs);
+  uint32_t dlogGetDropped(void);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* DLOG_H */
+
+/** @} */
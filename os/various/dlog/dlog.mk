@@ -0,0 +1,8 @@
+# Deferred logger files.
+DLOGSRC = ${CHIBIOS_RV}/os/various/dlog/dlog.c
+
+DLOGINC = ${CHIBIOS_RV}/os/various/dlog
+
+# Shared variables
+ALLCSRC += $(DLOGSRC)
+ALLINC  += $(DLOGINC)
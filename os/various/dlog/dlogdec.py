@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS - Copyright (C) 2020 Patrick Seidel
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Deferred logger host decoder.
+
+Reads the frames produced by dlog.c and prints the log text, the format
+strings come from the .dlog section of the firmware ELF file.
+
+    dlogdec.py build/ch.elf /dev/ttyUSB0          (needs pyserial)
+    dlogdec.py build/ch.elf capture.bin
+    dlogdec.py build/ch.elf - < capture.bin
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FRAME_RECORD = 0
+FRAME_DROPPED = 1
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?'
+                        r'([diouxXcsp%])')
+
+
+class Elf32:
+    """Minimal little endian ELF32 section reader."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1 or \
+           self.data[5] != 1:
+            raise ValueError('%s: not a little endian ELF32 file' % path)
+        shoff, = struct.unpack_from('<I', self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data,
+                                                        0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (name, stype, flags, addr, offset, size) = \
+                struct.unpack_from('<IIIIII', self.data,
+                                   shoff + i * shentsize)
+            self.sections.append([name, stype, flags, addr, offset, size])
+        strtab = self.sections[shstrndx]
+        for s in self.sections:
+            s[0] = self._cstring(strtab[4] + s[0])
+
+    def _cstring(self, offset):
+        end = self.data.index(b'\0', offset)
+        return self.data[offset:end].decode('utf-8', 'replace')
+
+    def section(self, name):
+        for s in self.sections:
+            if s[0] == name:
+                return s
+        raise KeyError('section %s not found' % name)
+
+    def string_at(self, section, offset):
+        return self._cstring(section[4] + offset)
+
+    def string_at_address(self, addr):
+        # Allocated sections with file contents, SHT_NOBITS excluded.
+        for s in self.sections:
+            if s[2] & 2 and s[1] != 8 and s[3] <= addr < s[3] + s[5]:
+                return self._cstring(s[4] + addr - s[3])
+        return '<%08x>' % addr
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            raise ValueError('malformed frame')
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def varint(buf, pos):
+    value = 0
+    shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if b < 0x80:
+            return value, pos
+        shift += 7
+
+
+def render(elf, fmt, args):
+    it = iter(args)
+
+    def conv(m):
+        flags, width, prec, _, kind = m.groups()
+        if kind == '%':
+            return '%'
+        if width == '*':
+            width = str(next(it))
+        value = next(it)
+        spec = '%' + flags + (width or '') + ('.' + prec if prec else '')
+        if kind in 'di':
+            value = value - (1 << 32) if value & 0x80000000 else value
+            return (spec + 'd') % value
+        if kind == 'c':
+            return (spec + 'c') % chr(value & 0xFF)
+        if kind == 's':
+            return (spec + 's') % elf.string_at_address(value)
+        if kind == 'p':
+            return (spec + 'x') % value
+        return (spec + kind) % value
+
+    try:
+        return CONVERSION.sub(conv, fmt)
+    except StopIteration:
+        return fmt + ' <missing arguments>'
+
+
+def frames(stream):
+    buf = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            return
+        if chunk[0] == 0:
+            if buf:
+                yield bytes(buf)
+            buf.clear()
+        else:
+            buf += chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('elf', help='firmware ELF file')
+    parser.add_argument('input', help='serial port, capture file or -')
+    parser.add_argument('-b', '--baud', type=int, default=38400,
+                        help='serial port bit rate')
+    parser.add_argument('-c', '--clock', type=float, default=320e6,
+                        help='mcycle frequency in Hz')
+    opts = parser.parse_args()
+
+    elf = Elf32(opts.elf)
+    fmts = elf.section('.dlog')
+
+    if opts.input == '-':
+        stream = sys.stdin.buffer
+    elif opts.input.startswith('/dev/') or opts.input.startswith('COM'):
+        import serial
+        stream = serial.Serial(opts.input, opts.baud)
+    else:
+        stream = open(opts.input, 'rb')
+
+    cycles = 0
+    for frame in frames(stream):
+        try:
+            payload = cobs_decode(frame)
+            tag, pos = varint(payload, 0)
+            delta, pos = varint(payload, pos)
+        except (ValueError, IndexError):
+            print('<corrupted frame>')
+            continue
+        if tag & 1 == FRAME_DROPPED:
+            print('<%d records dropped>' % (tag >> 1))
+            continue
+        cycles += delta
+        n = (len(payload) - pos) // 4
+        args = struct.unpack_from('<%dI' % n, payload, pos)
+        text = render(elf, elf.string_at(fmts, tag >> 1), args)
+        print('%14.6f %s' % (cycles / opts.clock, text))
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()